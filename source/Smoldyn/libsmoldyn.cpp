@@ -461,6 +461,20 @@ extern CSTRING enum ErrorCode smolSetRandomSeed(simptr sim,long int seed) {
 	return Liberrorcode; }
 
 
+/* smolSetThreads */
+extern CSTRING enum ErrorCode smolSetThreads(simptr sim,int nthreads) {
+	const char *funcname="smolSetThreads";
+	int er;
+
+	LCHECK(sim,funcname,ECmissing,"missing sim");
+	LCHECK(nthreads>0,funcname,ECbounds,"nthreads is not > 0");
+	er=simsetthreads(sim,nthreads);
+	LCHECK(!er,funcname,ECmemory,"out of memory");
+	return ECok;
+ failure:
+	return Liberrorcode; }
+
+
 /* smolSetPartitions */
 extern CSTRING enum ErrorCode smolSetPartitions(simptr sim,const char *method,double value) {
 	const char *funcname="smolSetPartitions";
@@ -69,6 +69,7 @@ enum ErrorCode smolSetTimeStop(simptr sim,double timestop);
 enum ErrorCode smolSetTimeNow(simptr sim,double timenow);
 enum ErrorCode smolSetTimeStep(simptr sim,double timestep);
 enum ErrorCode smolSetRandomSeed(simptr sim,long int seed);
+enum ErrorCode smolSetThreads(simptr sim,int nthreads);
 enum ErrorCode smolSetPartitions(simptr sim,const char *method,double value);
 
 /********************************** Graphics **********************************/
@@ -13,6 +13,7 @@
 #include "random2.h"
 #include "smoldyn.h"
 #include "smoldynfuncs.h"
+#include "smoldynconfigure.h"
 #include "Zn.h"
 
 /******************************************************************************/
@@ -25,7 +26,16 @@
 /******************************************************************************/
 
 // low level utilities
+static inline int boxpos2indx(boxssptr boxs,int d,double x);
+int boxunwrapindx(boxssptr boxs,int d,double x);
+double boxunwrapedge(boxssptr boxs,int d,int indx);
+static inline int pos2boxindexdim(boxssptr boxs,const double *pos,const int dim);
+static inline boxptr pos2boxdim(boxssptr boxs,const double *pos,const int dim);
+static inline int boxhash(int b,int mask);
 int panelinbox(simptr sim,panelptr pnl,boxptr bptr);
+void panelbounds(panelptr pnl,int dim,double *pmin,double *pmax);
+void panelboxrange(simptr sim,panelptr pnl,int *lo,int *hi);
+int boxpanelhits(simptr sim,panelptr *pnllist,int plo,int phi,int **hitptr,int *nhitptr);
 
 // memory management
 boxptr boxalloc(int dim,int nlist);
@@ -34,6 +44,9 @@ int expandboxpanels(boxptr bptr,int n);
 void boxfree(boxptr bptr,int nlist);
 boxptr *boxesalloc(int nbox,int dim,int nlist);
 void boxesfree(boxptr *blist,int nbox,int nlist);
+void boxcellfree(boxssptr boxs);
+void boxedgefree(boxssptr boxs);
+int boxrehash(boxssptr boxs,int maxhash);
 boxssptr boxssalloc(int dim);
 
 // data structure output
@@ -41,8 +54,18 @@ boxssptr boxssalloc(int dim);
 // structure set up
 int boxesupdateparams(simptr sim);
 int boxesupdatelists(simptr sim);
+void boxtunecandidates(simptr sim,double center);
+int boxtunebest(boxssptr boxs,int pmax);
+int boxtunenext(simptr sim,int p);
+int boxsettunewidth(simptr sim,double width);
+int boxadaptedges(simptr sim);
+int boxsetwalls(simptr sim,boxptr bptr);
+int boxsetneighbors(simptr sim,boxptr bptr,int *ntemp,int *wptemp);
+boxptr boxmake(boxssptr boxs,int b);
 
 // core simulation functions
+int boxcellbuild(simptr sim,int ll,int assign);
+static inline int reassignmolecsdim(simptr sim,int diffusing,int reborn,const int dim);
 
 
 /******************************************************************************/
@@ -56,6 +79,10 @@ void box2pos(simptr sim,boxptr bptr,double *poslo,double *poshi) {
 	double *size,*min;
 
 	dim=sim->dim;
+	if(sim->boxs->edge) {
+		if(poslo) for(d=0;d<dim;d++) poslo[d]=sim->boxs->edge[d][bptr->indx[d]];
+		if(poshi) for(d=0;d<dim;d++) poshi[d]=sim->boxs->edge[d][bptr->indx[d]+1];
+		return; }
 	size=sim->boxs->size;
 	min=sim->boxs->min;
 	if(poslo) for(d=0;d<dim;d++) poslo[d]=min[d]+bptr->indx[d]*size[d];
@@ -65,25 +92,106 @@ void box2pos(simptr sim,boxptr bptr,double *poslo,double *poshi) {
 
 /* pos2box */
 boxptr pos2box(simptr sim,const double *pos) {
-	int b,d,indx,dim;
-	boxssptr boxs;
+	return pos2boxdim(sim->boxs,pos,sim->dim); }
 
-	dim=sim->dim;
-	boxs=sim->boxs;
-	b=0;
-	for(d=0;d<dim;d++) {
-		indx=(int)((pos[d]-boxs->min[d])/boxs->size[d]);
+
+/* addr2box */
+boxptr addr2box(boxssptr boxs,int b,int create) {
+	int h,mask;
+
+	if(!boxs->hash) return boxs->blist[b];
+	mask=boxs->maxhash-1;
+	for(h=boxhash(b,mask);boxs->hash[2*h]!=-1;h=(h+1)&mask)
+		if(boxs->hash[2*h]==b) return boxs->blist[boxs->hash[2*h+1]];
+	if(create==1) return boxmake(boxs,b);
+	if(create==2) {
+		add2indxZV(b,boxs->tmpbox->indx,boxs->side,boxs->sim->dim);
+		return boxs->tmpbox; }
+	return NULL; }
+
+
+/* boxvolume */
+double boxvolume(simptr sim,boxptr bptr) {
+	int d;
+	double poslo[DIMMAX],poshi[DIMMAX],vol;
+
+	if(!sim->boxs->edge) return sim->boxs->boxvol;
+	box2pos(sim,bptr,poslo,poshi);
+	vol=1.0;
+	for(d=0;d<sim->dim;d++) vol*=poshi[d]-poslo[d];
+	return vol; }
+
+
+/* boxpos2indx */
+static inline int boxpos2indx(boxssptr boxs,int d,double x) {
+	int indx,lo,hi;
+	double *edge;
+
+	if(!boxs->edge) {
+		indx=(int)((x-boxs->min[d])/boxs->size[d]);
 		if(indx<0) indx=0;
 		else if(indx>=boxs->side[d]) indx=boxs->side[d]-1;
-		b=boxs->side[d]*b+indx; }
-	return boxs->blist[b]; }
+		return indx; }
+	edge=boxs->edge[d];														// binary search for adapted widths
+	lo=0;
+	hi=boxs->side[d]-1;
+	while(lo<hi) {
+		indx=(lo+hi+1)/2;
+		if(x>=edge[indx]) lo=indx;
+		else hi=indx-1; }
+	return lo; }
+
+
+/* boxunwrapindx */
+int boxunwrapindx(boxssptr boxs,int d,double x) {
+	int k;
+	double len;
+
+	len=boxs->size[d]*boxs->side[d];
+	k=(int)floor((x-boxs->min[d])/len);
+	return k*boxs->side[d]+boxpos2indx(boxs,d,x-k*len); }
+
+
+/* boxunwrapedge */
+double boxunwrapedge(boxssptr boxs,int d,int indx) {
+	int k;
+
+	k=indx>=0?indx/boxs->side[d]:-((-indx-1)/boxs->side[d])-1;
+	indx-=k*boxs->side[d];
+	return (boxs->edge?boxs->edge[d][indx]:boxs->min[d]+indx*boxs->size[d])+k*boxs->size[d]*boxs->side[d]; }
+
+
+/* pos2boxindexdim */
+static inline int pos2boxindexdim(boxssptr boxs,const double *pos,const int dim) {
+	int b,d;
+
+	b=0;
+	for(d=0;d<dim;d++)
+		b=boxs->side[d]*b+boxpos2indx(boxs,d,pos[d]);
+	return b; }
+
+
+/* pos2boxdim */
+static inline boxptr pos2boxdim(boxssptr boxs,const double *pos,const int dim) {
+	if(boxs->hash) return addr2box(boxs,pos2boxindexdim(boxs,pos,dim),1);
+	return boxs->blist[pos2boxindexdim(boxs,pos,dim)]; }
+
+
+/* boxhash */
+static inline int boxhash(int b,int mask) {
+	return (int)(((unsigned int)b*2654435761u)&(unsigned int)mask); }
 
 
 /* boxrandpos */
 void boxrandpos(simptr sim,double *pos,boxptr bptr) {
 	int d;
-	double *min,*size;
+	double *min,*size,poslo[DIMMAX],poshi[DIMMAX];
 
+	if(sim->boxs->edge) {
+		box2pos(sim,bptr,poslo,poshi);
+		for(d=0;d<sim->dim;d++)
+			pos[d]=unirandCCD(poslo[d],poshi[d]);
+		return; }
 	min=sim->boxs->min;
 	size=sim->boxs->size;
 	for(d=0;d<sim->dim;d++)
@@ -152,13 +260,57 @@ int panelinbox(simptr sim,panelptr pnl,boxptr bptr) {
 	return cross; }
 
 
+/* panelbounds */
+void panelbounds(panelptr pnl,int dim,double *pmin,double *pmax) {
+	int d,npt,k;
+	double **point,r;
+
+	point=pnl->point;
+	if(pnl->ps==PSrect || pnl->ps==PStri) {				// panels with corners
+		npt=pnl->ps==PStri?dim:(dim==1?1:(dim==2?2:4));
+		for(d=0;d<dim;d++) pmin[d]=pmax[d]=point[0][d];
+		for(k=1;k<npt;k++)
+			for(d=0;d<dim;d++) {
+				if(point[k][d]<pmin[d]) pmin[d]=point[k][d];
+				else if(point[k][d]>pmax[d]) pmax[d]=point[k][d]; }}
+	else if(pnl->ps==PScyl) {											// cylinder, from ends and radius
+		r=point[2][0];
+		for(d=0;d<dim;d++) {
+			pmin[d]=(point[0][d]<point[1][d]?point[0][d]:point[1][d])-r;
+			pmax[d]=(point[0][d]>point[1][d]?point[0][d]:point[1][d])+r; }}
+	else {																				// sphere, hemisphere, disk, from center and radius
+		r=point[1][0];
+		for(d=0;d<dim;d++) {
+			pmin[d]=point[0][d]-r;
+			pmax[d]=point[0][d]+r; }}
+	return; }
+
+
+/* panelboxrange */
+void panelboxrange(simptr sim,panelptr pnl,int *lo,int *hi) {
+	int dim,d;
+	double pmin[DIMMAX],pmax[DIMMAX];
+	boxssptr boxs;
+
+	dim=sim->dim;
+	boxs=sim->boxs;
+	panelbounds(pnl,dim,pmin,pmax);
+	for(d=0;d<dim;d++) {													// panels on box edges are in both boxes
+		lo[d]=boxpos2indx(boxs,d,pmin[d]-1e-6*boxs->size[d]);
+		hi[d]=boxpos2indx(boxs,d,pmax[d]+1e-6*boxs->size[d]); }
+	return; }
+
+
 /* boxaddmol */
 int boxaddmol(moleculeptr mptr,int ll) {
 	boxptr bptr;
 
 	bptr=mptr->box;
-	if(bptr->nmol[ll]==bptr->maxmol[ll])
-		if(expandbox(bptr,bptr->maxmol[ll]+1,ll)) return 1;
+	if(bptr->nmol[ll]==bptr->maxmol[ll]) {
+		if(bptr->boxs && bptr->boxs->cellmol)				// contiguous lists are rebuilt instead
+			return boxcellbuild(bptr->boxs->sim,ll,0);
+		if(expandbox(bptr,bptr->maxmol[ll]+1,ll)) return 1; }
+	mptr->boxm=bptr->nmol[ll];
 	bptr->mol[ll][bptr->nmol[ll]++]=mptr;
 	return 0; }
 
@@ -169,9 +321,14 @@ void boxremovemol(moleculeptr mptr,int ll) {
 	boxptr bptr;
 
 	bptr=mptr->box;
-	for(m=bptr->nmol[ll]-1;m>=0 && bptr->mol[ll][m]!=mptr;m--);
-	if(m>=0) bptr->mol[ll][m]=bptr->mol[ll][--bptr->nmol[ll]];
+	m=mptr->boxm;
+	if(m<0 || m>=bptr->nmol[ll] || bptr->mol[ll][m]!=mptr)			// back-index is stale, so search
+		for(m=bptr->nmol[ll]-1;m>=0 && bptr->mol[ll][m]!=mptr;m--);
+	if(m>=0) {
+		bptr->mol[ll][m]=bptr->mol[ll][--bptr->nmol[ll]];
+		bptr->mol[ll][m]->boxm=m; }
 	mptr->box=NULL;
+	mptr->boxm=-1;
 	return; }
 
 
@@ -188,8 +345,12 @@ boxptr boxscansphere(simptr sim,const double *pos,double radius,boxptr bptr,int
 	if(bptr==NULL) {		// first call
 		boxdiameter=0;
 		for(d=0;d<dim;d++) {
-			startindex[d]=(int) floor(((pos[d]-boxs->min[d])-radius)/boxs->size[d]);			// first box to consider
-			diam=(int) ceil(((pos[d]-boxs->min[d])+radius)/boxs->size[d])-startindex[d];
+			if(boxs->edge) {
+				startindex[d]=boxunwrapindx(boxs,d,pos[d]-radius);
+				diam=boxunwrapindx(boxs,d,pos[d]+radius)+1-startindex[d]; }
+			else {
+				startindex[d]=(int) floor(((pos[d]-boxs->min[d])-radius)/boxs->size[d]);			// first box to consider
+				diam=(int) ceil(((pos[d]-boxs->min[d])+radius)/boxs->size[d])-startindex[d]; }
 			if(diam>boxdiameter) boxdiameter=diam;	// largest diameter in boxes, giving count range
 			deltaindex[d]=0; }}											// working index relative to startindex
 	else {							// subsequent calls
@@ -201,8 +362,12 @@ boxptr boxscansphere(simptr sim,const double *pos,double radius,boxptr bptr,int
 		keepgoing=0;	// expect a good box
 		for(d=0;d<dim;d++) {
 			index[d]=startindex[d]+deltaindex[d];			// index of box, ignoring edges and wrapping
-			boxmin[d]=boxs->min[d]+boxs->size[d]*index[d];			// min corner of box, ignoring edges and wrapping
-			boxmax[d]=boxs->min[d]+boxs->size[d]*(index[d]+1);	// max corner of box, ignoring edges and wrapping
+			if(boxs->edge) {
+				boxmin[d]=boxunwrapedge(boxs,d,index[d]);
+				boxmax[d]=boxunwrapedge(boxs,d,index[d]+1); }
+			else {
+				boxmin[d]=boxs->min[d]+boxs->size[d]*index[d];			// min corner of box, ignoring edges and wrapping
+				boxmax[d]=boxs->min[d]+boxs->size[d]*(index[d]+1); }	// max corner of box, ignoring edges and wrapping
 			wrap[d]=0;
 			if(index[d]<0) {
 				if(sim->wlist[2*d]->type=='p')
@@ -221,6 +386,9 @@ boxptr boxscansphere(simptr sim,const double *pos,double radius,boxptr bptr,int
 		dist=Geo_NearestAabbPt(boxmin,boxmax,dim,pos,v1);
 		if(dist>radius)
 			keepgoing=1;
+		if(!keepgoing && boxs->hash) {			// unallocated sparse boxes are empty, so skip them
+			for(b=0,d=0;d<dim;d++) b=boxs->side[d]*b+index[d];
+			if(!addr2box(boxs,b,0)) keepgoing=1; }
 		if(keepgoing) {
 			done=Zn_incrementcounter(deltaindex,dim,boxdiameter);
 			if(done) return NULL; }}
@@ -228,7 +396,7 @@ boxptr boxscansphere(simptr sim,const double *pos,double radius,boxptr bptr,int
 	b=0;																				// compute the box number with this index
 	for(d=0;d<dim;d++)
 		b=boxs->side[d]*b+index[d];
-	bptr=boxs->blist[b];
+	bptr=addr2box(boxs,b,0);
 
 	return bptr; }
 
@@ -298,6 +466,8 @@ boxptr boxalloc(int dim,int nlist) {
 	bptr->maxmol=NULL;
 	bptr->nmol=NULL;
 	bptr->mol=NULL;
+	bptr->boxs=NULL;
+	bptr->bnum=0;
 
 	CHECKMEM(bptr->indx=(int*) calloc(dim,sizeof(int)));
 	for(d=0;d<dim;d++) bptr->indx[d]=0;
@@ -405,10 +575,59 @@ void boxesfree(boxptr *blist,int nbox,int nlist) {
 	return; }
 
 
+/* boxcellfree */
+void boxcellfree(boxssptr boxs) {
+	int b,ll;
+
+	if(!boxs->cellmol) return;
+	for(b=0;b<boxs->nbox;b++)											// boxes don't own contiguous lists
+		for(ll=0;ll<boxs->nlist;ll++) {
+			boxs->blist[b]->mol[ll]=NULL;
+			boxs->blist[b]->maxmol[ll]=0;
+			boxs->blist[b]->nmol[ll]=0; }
+	for(ll=0;ll<boxs->nlist;ll++) free(boxs->cellmol[ll]);
+	free(boxs->cellmol);
+	free(boxs->maxcellmol);
+	boxs->cellmol=NULL;
+	boxs->maxcellmol=NULL;
+	return; }
+
+
+/* boxedgefree */
+void boxedgefree(boxssptr boxs) {
+	int d;
+
+	if(!boxs->edge) return;
+	for(d=0;d<DIMMAX;d++)
+		free(boxs->edge[d]);
+	free(boxs->edge);
+	boxs->edge=NULL;
+	return; }
+
+
+/* boxrehash */
+int boxrehash(boxssptr boxs,int maxhash) {
+	int *hash,h,h2,mask;
+
+	hash=(int*) calloc(2*maxhash,sizeof(int));
+	if(!hash) return 1;
+	for(h=0;h<maxhash;h++) hash[2*h]=-1;
+	mask=maxhash-1;
+	for(h2=0;h2<boxs->maxhash;h2++)
+		if(boxs->hash[2*h2]!=-1) {
+			for(h=boxhash(boxs->hash[2*h2],mask);hash[2*h]!=-1;h=(h+1)&mask);
+			hash[2*h]=boxs->hash[2*h2];
+			hash[2*h+1]=boxs->hash[2*h2+1]; }
+	free(boxs->hash);
+	boxs->hash=hash;
+	boxs->maxhash=maxhash;
+	return 0; }
+
+
 /* boxssalloc */
 boxssptr boxssalloc(int dim) {
 	boxssptr boxs;
-	int d;
+	int d,k;
 
 	boxs=NULL;
 	CHECKMEM(boxs=(boxssptr) malloc(sizeof(struct boxsuperstruct)));
@@ -417,11 +636,32 @@ boxssptr boxssalloc(int dim) {
 	boxs->nlist=0;
 	boxs->mpbox=0;
 	boxs->boxsize=0;
+	boxs->tunesteps=0;
+	boxs->tunethresh=0.5;
+	boxs->tunecand=-1;
+	boxs->tunect=0;
+	boxs->tuneround=0;
+	boxs->tunenmol=-1;
+	for(k=0;k<BOXTUNE;k++) boxs->tunewidth[k]=boxs->tunecost[k]=0;
+	boxs->cellstore=0;
+	boxs->cellmol=NULL;
+	boxs->maxcellmol=NULL;
+	boxs->maxcellct=0;
+	boxs->cellct=NULL;
 	boxs->boxvol=0;
 	boxs->nbox=0;
+	boxs->ngrid=0;
 	boxs->side=NULL;
 	boxs->min=NULL;
 	boxs->size=NULL;
+	boxs->adapt=0;
+	boxs->adaptrad=0;
+	boxs->edge=NULL;
+	boxs->sparse=0;
+	boxs->maxbox=0;
+	boxs->maxhash=0;
+	boxs->hash=NULL;
+	boxs->tmpbox=NULL;
 	boxs->blist=NULL;
 
 	CHECKMEM(boxs->side=(int*) calloc(dim,sizeof(int)));
@@ -441,7 +681,12 @@ boxssptr boxssalloc(int dim) {
 /* boxssfree */
 void boxssfree(boxssptr boxs) {
 	if(!boxs) return;
+	boxcellfree(boxs);
+	free(boxs->cellct);
 	boxesfree(boxs->blist,boxs->nbox,boxs->nlist);
+	free(boxs->hash);
+	boxfree(boxs->tmpbox,0);
+	boxedgefree(boxs);
 	free(boxs->size);
 	free(boxs->min);
 	free(boxs->side);
@@ -505,7 +750,7 @@ void boxoutput(boxssptr boxs,int blo,int bhi,int dim) {
 
 /* boxssoutput */
 void boxssoutput(simptr sim) {
-	int dim,d,ll;
+	int dim,d,ll,k;
 	boxssptr boxs;
 	double flt1;
 
@@ -515,7 +760,8 @@ void boxssoutput(simptr sim) {
 		return; }
 	dim=sim->dim;
 	boxs=sim->boxs;
-	simLog(sim,2," %i boxes\n",boxs->nbox);
+	if(boxs->sparse) simLog(sim,2," %i boxes, of which %i are allocated; boxes are allocated when first used\n",boxs->ngrid,boxs->nbox);
+	else simLog(sim,2," %i boxes\n",boxs->nbox);
 	simLog(sim,2," Number of boxes on each side:");
 	for(d=0;d<dim;d++) simLog(sim,2," %i",boxs->side[d]);
 	simLog(sim,2,"\n");
@@ -524,9 +770,21 @@ void boxssoutput(simptr sim) {
 	simLog(sim,1,"\n");
 	if(boxs->boxsize) simLog(sim,2," Requested box width: %g|L\n",boxs->boxsize);
 	if(boxs->mpbox) simLog(sim,2," Requested molecules per box: %g\n",boxs->mpbox);
-	simLog(sim,2," Box dimensions: ");
+	if(boxs->cellstore) simLog(sim,2," Box molecule lists are stored contiguously\n");
+	if(boxs->tunesteps) simLog(sim,2," Box width is autotuned with %i step samples, retuned after %g relative change in molecule number\n",boxs->tunesteps,boxs->tunethresh);
+	simLog(sim,2,boxs->edge?" Average box dimensions: ":" Box dimensions: ");
 	for(d=0;d<dim;d++) simLog(sim,2," %g|L",boxs->size[d]);
 	simLog(sim,2,"\n");
+	if(boxs->edge) {
+		simLog(sim,2," Box widths are adapted to molecule and panel density, smallest widths:");
+		for(d=0;d<dim;d++) {
+			flt1=boxs->edge[d][1]-boxs->edge[d][0];
+			for(k=1;k<boxs->side[d];k++)
+				if(boxs->edge[d][k+1]-boxs->edge[d][k]<flt1) flt1=boxs->edge[d][k+1]-boxs->edge[d][k];
+			simLog(sim,2," %g|L",flt1); }
+		simLog(sim,2,"\n"); }
+	else if(boxs->adapt)
+		simLog(sim,2," Box widths will be adapted to molecule and panel density\n");
 	if(boxs->boxvol>0) {
 		if(dim==1) simLog(sim,2," Box volumes: %g|L\n",boxs->boxvol);
 		else if(dim==2) simLog(sim,2," Box volumes: %g|L2\n",boxs->boxvol);
@@ -538,7 +796,7 @@ void boxssoutput(simptr sim) {
 		flt1=0;
 		for(ll=0;ll<sim->mols->nlist;ll++)
 			if(sim->mols->listtype[ll]==MLTsystem) flt1+=sim->mols->nl[ll];
-		flt1/=boxs->nbox;
+		flt1/=boxs->ngrid;
 		simLog(sim,2," Molecules per box= %g\n",flt1);
 		simLog(sim,2,"\n"); }
 
@@ -630,16 +888,398 @@ int boxsetsize(simptr sim,const char *info,double val) {
 	return 0; }
 
 
+/* boxsetautotune */
+int boxsetautotune(simptr sim,int steps,double thresh) {
+	boxssptr boxs;
+
+	if(steps<0 || thresh<=0) return 2;
+	if(!sim->boxs) {
+		if(!sim->dim) return 3;
+		boxs=boxssalloc(sim->dim);
+		if(!boxs) return 1;
+		boxs->sim=sim;
+		sim->boxs=boxs;
+		boxsetcondition(boxs,SCinit,0); }
+	else
+		boxs=sim->boxs;
+	boxs->tunesteps=steps;
+	boxs->tunethresh=thresh;
+	boxs->tunecand=-1;
+	boxs->tunect=0;
+	boxs->tunenmol=-1;
+	return 0; }
+
+
+/* boxsetcellstore */
+int boxsetcellstore(simptr sim,int cellstore) {
+	boxssptr boxs;
+
+	if(!sim->boxs) {
+		if(!sim->dim) return 3;
+		boxs=boxssalloc(sim->dim);
+		if(!boxs) return 1;
+		boxs->sim=sim;
+		sim->boxs=boxs;
+		boxsetcondition(boxs,SCinit,0); }
+	else
+		boxs=sim->boxs;
+	boxs->cellstore=cellstore?1:0;
+	boxsetcondition(boxs,SClists,0);
+	return 0; }
+
+
+/* boxsetadapt */
+int boxsetadapt(simptr sim,int adapt) {
+	boxssptr boxs;
+
+	if(!sim->boxs) {
+		if(!sim->dim) return 3;
+		boxs=boxssalloc(sim->dim);
+		if(!boxs) return 1;
+		boxs->sim=sim;
+		sim->boxs=boxs;
+		boxsetcondition(boxs,SCinit,0); }
+	else
+		boxs=sim->boxs;
+	boxs->adapt=adapt?1:0;
+	boxsetcondition(boxs,SClists,0);
+	compartsetcondition(sim->cmptss,SCparams,0);	// compartments list boxes
+	return 0; }
+
+
+/* boxsetsparse */
+int boxsetsparse(simptr sim,int sparse) {
+	boxssptr boxs;
+
+	if(!sim->boxs) {
+		if(!sim->dim) return 3;
+		boxs=boxssalloc(sim->dim);
+		if(!boxs) return 1;
+		boxs->sim=sim;
+		sim->boxs=boxs;
+		boxsetcondition(boxs,SCinit,0); }
+	else
+		boxs=sim->boxs;
+	boxs->sparse=sparse?1:0;
+	boxsetcondition(boxs,SClists,0);
+	compartsetcondition(sim->cmptss,SCparams,0);	// compartments list boxes
+	return 0; }
+
+
+/* boxtunecandidates */
+void boxtunecandidates(simptr sim,double center) {
+	boxssptr boxs;
+	rxnssptr rxnss;
+	int k,d,r,side,nbox;
+	double width,minwidth,size,minsize,maxbox;
+
+	boxs=sim->boxs;
+	minwidth=0;																			// boxes need to be at least as large as binding radii
+	rxnss=sim->rxnss[2];
+	if(rxnss)
+		for(r=0;r<rxnss->totrxn;r++)
+			if(rxnss->rxn[r]->bindrad2>minwidth*minwidth) minwidth=sqrt(rxnss->rxn[r]->bindrad2);
+	maxbox=10.0*(molcount(sim,-5,NULL,MSall,-1)+100);	// limit memory use for very small boxes
+
+	for(k=0;k<BOXTUNE;k++) {
+		width=center*pow(2.0,0.5*(k-BOXTUNE/2));
+		nbox=1;
+		minsize=width;
+		for(d=0;d<sim->dim;d++) {
+			side=(int)ceil((sim->wlist[2*d+1]->pos-sim->wlist[2*d]->pos)*(1.0/width));
+			if(!side) side=1;
+			size=(sim->wlist[2*d+1]->pos-sim->wlist[2*d]->pos)/side;
+			if(size<minsize) minsize=size;
+			nbox*=side; }
+		if(minsize<minwidth || nbox>maxbox) width=-1;	// not allowed
+		boxs->tunewidth[k]=width;
+		boxs->tunecost[k]=0; }
+	return; }
+
+
+/* boxtunebest */
+int boxtunebest(boxssptr boxs,int pmax) {
+	int p,k,best;
+
+	best=-1;
+	for(p=0;p<pmax && p<BOXTUNE;p++) {
+		k=p<=BOXTUNE/2?BOXTUNE/2-p:p;
+		if(boxs->tunewidth[k]>0 && (best<0 || boxs->tunecost[k]<boxs->tunecost[best])) best=k; }
+	return best; }
+
+
+/* boxtunenext */
+int boxtunenext(simptr sim,int p) {
+	boxssptr boxs;
+	int k,center;
+
+	boxs=sim->boxs;
+	center=BOXTUNE/2;
+	boxs->tunect=0;
+	for(;p<BOXTUNE;p++) {
+		k=p<=center?center-p:p;
+		if(boxs->tunewidth[k]<=0) continue;
+		if(k==center || boxtunebest(boxs,p)==(k<center?k+1:k-1)) {	// only go outward while it improves
+			boxs->tunecand=k;
+			boxsettunewidth(sim,boxs->tunewidth[k]);
+			return 1; }
+		boxs->tunewidth[k]=-1; }
+	boxs->tunecand=-1;
+	return 0; }
+
+
+/* boxsettunewidth */
+int boxsettunewidth(simptr sim,double width) {
+	boxssptr boxs;
+	int d,side,same;
+
+	boxs=sim->boxs;
+	same=1;
+	for(d=0;d<sim->dim && same;d++) {
+		side=(int)ceil((sim->wlist[2*d+1]->pos-sim->wlist[2*d]->pos)*(1.0/width));
+		if(!side) side=1;
+		if(side!=boxs->side[d]) same=0; }
+	if(same) return 0;
+
+	boxs->mpbox=0;
+	boxs->boxsize=width;
+	boxsetcondition(boxs,SClists,0);
+	compartsetcondition(sim->cmptss,SCparams,0);	// compartments list boxes
+	return 1; }
+
+
+/* boxadaptedges */
+int boxadaptedges(simptr sim) {
+	int finebins=16;		// histogram bins per box for density estimate
+	int maxrefine=4;		// maximum ratio of average to smallest box width
+	boxssptr boxs;
+	molssptr mols;
+	rxnssptr rxnss;
+	surfaceptr srf;
+	enum PanelShape ps;
+	int dim,d,n,nfine,j,k,ll,m,s,p,r;
+	double lo,len,wmin,bgnd,target,total,x,*cum,*edge,pmin[DIMMAX],pmax[DIMMAX];
+
+	boxs=sim->boxs;
+	mols=sim->mols;
+	dim=sim->dim;
+	boxedgefree(boxs);
+	boxs->adaptrad=0;																// boxes need to be at least as large as binding radii
+	rxnss=sim->rxnss[2];
+	if(rxnss)
+		for(r=0;r<rxnss->totrxn;r++)
+			if(rxnss->rxn[r]->bindrad2>boxs->adaptrad*boxs->adaptrad) boxs->adaptrad=sqrt(rxnss->rxn[r]->bindrad2);
+
+	boxs->edge=(double**) calloc(DIMMAX,sizeof(double*));
+	if(!boxs->edge) return 1;
+	for(d=0;d<dim;d++) {
+		n=boxs->side[d];
+		nfine=finebins*n;
+		edge=boxs->edge[d]=(double*) calloc(n+1,sizeof(double));
+		cum=(double*) calloc(nfine+1,sizeof(double));
+		if(!edge || !cum) {
+			free(cum);
+			return 1; }
+		lo=boxs->min[d];
+		len=boxs->size[d]*n;
+
+		total=0;																			// histogram of molecule and panel positions
+		if(mols) {
+			for(ll=0;ll<mols->nlist;ll++)
+				if(mols->listtype[ll]==MLTsystem)
+					for(m=0;m<mols->nl[ll];m++) {
+						j=(int)((mols->live[ll][m]->pos[d]-lo)/len*nfine);
+						cum[j<0?1:(j>=nfine?nfine:j+1)]++;
+						total++; }
+			for(m=mols->topd;m<mols->nd;m++)
+				if(mols->dead[m]->ident>0) {
+					j=(int)((mols->dead[m]->pos[d]-lo)/len*nfine);
+					cum[j<0?1:(j>=nfine?nfine:j+1)]++;
+					total++; }}
+		if(sim->srfss)
+			for(s=0;s<sim->srfss->nsrf;s++) {
+				srf=sim->srfss->srflist[s];
+				for(ps=(enum PanelShape)0;ps<PSMAX;ps=(enum PanelShape)(ps+1))
+					for(p=0;p<srf->npanel[ps];p++) {
+						panelbounds(srf->panels[ps][p],dim,pmin,pmax);
+						x=0.5*(pmin[d]+pmax[d]);
+						j=(int)((x-lo)/len*nfine);
+						cum[j<0?1:(j>=nfine?nfine:j+1)]++;
+						total++; }}
+		bgnd=total>0?total/3.0/nfine:1;								// uniform background, 1/4 of the total
+		for(j=0;j<nfine;j++) cum[j+1]+=cum[j]+bgnd;		// cumulative distribution
+
+		edge[0]=lo;																		// edges at equal steps of distribution
+		edge[n]=lo+len;
+		j=0;
+		for(k=1;k<n;k++) {
+			target=cum[nfine]*k/n;
+			while(j<nfine-1 && cum[j+1]<target) j++;
+			edge[k]=lo+len*(j+(target-cum[j])/(cum[j+1]-cum[j]))/nfine; }
+		free(cum);
+
+		wmin=boxs->size[d]/maxrefine;									// enforce minimum width
+		if(wmin<boxs->adaptrad) wmin=boxs->adaptrad;
+		if(wmin>boxs->size[d]) wmin=boxs->size[d];
+		for(k=1;k<n;k++)
+			if(edge[k]<edge[k-1]+wmin) edge[k]=edge[k-1]+wmin;
+		for(k=n-1;k>0;k--)
+			if(edge[k]>edge[k+1]-wmin) edge[k]=edge[k+1]-wmin; }
+	return 0; }
+
+
+/* boxsetwalls */
+int boxsetwalls(simptr sim,boxptr bptr) {
+	int dim,d,w,nwall,*indx,*side;
+
+	dim=sim->dim;
+	side=sim->boxs->side;
+	indx=bptr->indx;
+	nwall=0;
+	for(d=0;d<dim;d++) {
+		if(indx[d]==0) nwall++;
+		if(indx[d]==side[d]-1) nwall++; }
+	if(nwall && nwall!=bptr->nwall) {
+		free(bptr->wlist);
+		bptr->wlist=(wallptr*) calloc(nwall,sizeof(wallptr));
+		if(!bptr->wlist) return 1;
+		bptr->nwall=nwall; }
+	if(nwall) {
+		w=0;
+		for(d=0;d<dim;d++) {
+			if(indx[d]==0) bptr->wlist[w++]=sim->wlist[2*d];
+			if(indx[d]==side[d]-1) bptr->wlist[w++]=sim->wlist[2*d+1]; }}
+	return 0; }
+
+
+/* boxsetneighbors */
+int boxsetneighbors(simptr sim,boxptr bptr,int *ntemp,int *wptemp) {
+	int dim,w,nneigh,mid,b2,n;
+	boxptr bptr2;
+
+	dim=sim->dim;
+	if(sim->accur<6)
+		nneigh=neighborZV(bptr->indx,ntemp,sim->boxs->side,dim,0,NULL,&mid);
+	else {
+		for(w=0;w<2*dim;w++) wptemp[w]=(sim->wlist[w]->type=='p' && sim->srfss==NULL);
+		nneigh=neighborZV(bptr->indx,ntemp,sim->boxs->side,dim,sim->accur<9?6:7,wptemp,&mid); }
+	if(nneigh==-1) return 1;
+	w=0;
+	if(sim->accur>=6) for(b2=0;b2<nneigh;b2++) w+=wptemp[b2];
+
+	if(nneigh && !bptr->neigh) {
+		// See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=85783
+		bptr->neigh=(boxptr*) calloc((unsigned int) nneigh,sizeof(boxptr));
+		if(!bptr->neigh) return 1; }
+	if(w && !bptr->wpneigh) {
+		bptr->wpneigh=allocZV(nneigh);
+		if(!bptr->wpneigh) return 1; }
+
+	n=0;																							// only list allocated neighbors
+	bptr->midneigh=0;
+	for(b2=0;b2<nneigh;b2++) {
+		bptr2=addr2box(sim->boxs,ntemp[b2],0);
+		if(bptr2) {
+			if(b2<mid) bptr->midneigh++;
+			bptr->neigh[n]=bptr2;
+			if(w) bptr->wpneigh[n]=wptemp[b2];
+			n++; }}
+	bptr->nneigh=n;
+	return 0; }
+
+
+/* boxmake */
+boxptr boxmake(boxssptr boxs,int b) {
+	simptr sim;
+	boxptr bptr,*newblist;
+	int maxbox,b2,ntemp[27],wptemp[27];
+
+	sim=boxs->sim;
+	if(boxs->nbox==boxs->maxbox) {										// expand blist
+		maxbox=2*boxs->maxbox+1;
+		newblist=(boxptr*) calloc(maxbox,sizeof(boxptr));
+		if(!newblist) goto failure;
+		for(b2=0;b2<boxs->nbox;b2++) newblist[b2]=boxs->blist[b2];
+		for(;b2<maxbox;b2++) newblist[b2]=NULL;
+		free(boxs->blist);
+		boxs->blist=newblist;
+		boxs->maxbox=maxbox; }
+	if(2*(boxs->nbox+1)>boxs->maxhash)								// keep hash table at most half full
+		if(boxrehash(boxs,2*boxs->maxhash)) goto failure;
+
+	bptr=boxalloc(sim->dim,boxs->nlist);
+	if(!bptr) goto failure;
+	bptr->boxs=boxs;
+	bptr->bnum=boxs->nbox;
+	add2indxZV(b,bptr->indx,boxs->side,sim->dim);
+	for(b2=boxhash(b,boxs->maxhash-1);boxs->hash[2*b2]!=-1;b2=(b2+1)&(boxs->maxhash-1));
+	boxs->hash[2*b2]=b;
+	boxs->hash[2*b2+1]=boxs->nbox;
+	boxs->blist[boxs->nbox++]=bptr;
+
+	if(boxsetwalls(sim,bptr)) goto failure;
+	if(sim->accur>=3) {																// neighbors, both ways
+		if(boxsetneighbors(sim,bptr,ntemp,wptemp)) goto failure;
+		for(b2=0;b2<bptr->nneigh;b2++)
+			if(boxsetneighbors(sim,bptr->neigh[b2],ntemp,wptemp)) goto failure;
+		neighborZV(NULL,NULL,NULL,0,-1,NULL,NULL); }
+	return bptr;
+
+ failure:
+	simLog(sim,10,"Failed to allocate memory in boxmake");
+	return NULL; }
+
+
+/* boxpanelhits */
+int boxpanelhits(simptr sim,panelptr *pnllist,int plo,int phi,int **hitptr,int *nhitptr) {
+	int p,b,b1,b2,dim,nhit,maxhit,*hit,*newhit,lo[DIMMAX],hi[DIMMAX],indx[DIMMAX];
+	boxssptr boxs;
+	struct boxstruct tmpbox;
+	boxptr bptr;
+
+	dim=sim->dim;
+	boxs=sim->boxs;
+	tmpbox.indx=indx;														// sparse boxes may not exist yet
+	nhit=maxhit=0;
+	hit=NULL;
+	for(p=plo;p<phi;p++) {
+		panelboxrange(sim,pnllist[p],lo,hi);
+		b1=indx2addZV(lo,boxs->side,dim);
+		b2=indx2addZV(hi,boxs->side,dim);
+		for(b=b1;b<=b2;b=nextaddZV(b,lo,hi,boxs->side,dim)) {
+			if(boxs->hash) {
+				add2indxZV(b,indx,boxs->side,dim);
+				bptr=&tmpbox; }
+			else
+				bptr=boxs->blist[b];
+			if(panelinbox(sim,pnllist[p],bptr)) {
+				if(nhit==maxhit) {
+					maxhit=2*maxhit+16;
+					newhit=(int*) realloc(hit,2*maxhit*sizeof(int));
+					if(!newhit) {
+						free(hit);
+						*hitptr=NULL;
+						*nhitptr=0;
+						return 1; }
+					hit=newhit; }
+				hit[2*nhit]=p;
+				hit[2*nhit+1]=b;
+				nhit++; }}}
+	*hitptr=hit;
+	*nhitptr=nhit;
+	return 0; }
+
+
 /* boxesupdateparams */
 int boxesupdateparams(simptr sim) {
 	int m,mlo,mhi,nbox,b,ll,ll1,mxml,er,npanel;
 	boxssptr boxs;
 	boxptr *blist,bptr;
-	int nsrf,s,p;
+	int nsrf,s,p,p2,npnl,nthreads,t,*nhit,**hit;
 	surfaceptr srf;
 	moleculeptr mptr,*mlist;
 	enum PanelShape ps;
-	panelptr pnl;
+	panelptr *pnllist;
 
 	boxs=sim->boxs;
 	nbox=boxs->nbox;
@@ -649,27 +1289,70 @@ int boxesupdateparams(simptr sim) {
 		for(b=0;b<nbox;b++)
 			blist[b]->npanel=0;
 		nsrf=sim->srfss->nsrf;
-		for(b=0;b<nbox;b++) {														// box->npanel, panel
-			bptr=blist[b];
-			npanel=0;
-			for(s=0;s<nsrf;s++) {
+		npnl=0;
+		for(s=0;s<nsrf;s++)
+			for(ps=(enum PanelShape)0;ps<PSMAX;ps=(enum PanelShape)(ps+1))
+				npnl+=sim->srfss->srflist[s]->npanel[ps];
+		if(npnl) {
+			nthreads=sim->nthreads>1?sim->nthreads:1;
+			pnllist=(panelptr*) calloc(npnl,sizeof(panelptr));
+			hit=(int**) calloc(nthreads,sizeof(int*));
+			nhit=(int*) calloc(nthreads,sizeof(int));
+			if(!pnllist || !hit || !nhit) {
+				free(pnllist);
+				free(hit);
+				free(nhit);
+				return 1; }
+			p2=0;
+			for(s=0;s<nsrf;s++) {											// all panels, in surface order
 				srf=sim->srfss->srflist[s];
 				for(ps=(enum PanelShape)0;ps<PSMAX;ps=(enum PanelShape)(ps+1))
-					for(p=0;p<srf->npanel[ps];p++) {
-						pnl=srf->panels[ps][p];
-						if(panelinbox(sim,pnl,bptr)) npanel++; }}
-			if(npanel && npanel>bptr->maxpanel) {
-				er=expandboxpanels(bptr,npanel-bptr->maxpanel);
-				if(er) return 1; }
-			if(npanel) {
-				for(s=0;s<nsrf;s++) {
-					srf=sim->srfss->srflist[s];
-					for(ps=(enum PanelShape)0;ps<PSMAX;ps=(enum PanelShape)(ps+1))
-						for(p=0;p<srf->npanel[ps];p++)
-							if(panelinbox(sim,srf->panels[ps][p],bptr))
-								bptr->panel[bptr->npanel++]=srf->panels[ps][p]; }}}}
-
-	if(sim->mols) {												// mptr->box, box->maxmol, nmol, mol
+					for(p=0;p<srf->npanel[ps];p++)
+						pnllist[p2++]=srf->panels[ps][p]; }
+
+			er=0;																			// find boxes that each panel is in
+#ifdef HAVE_OPENMP
+			#pragma omp parallel for num_threads(nthreads) schedule(static,1) reduction(+:er)
+#endif
+			for(t=0;t<nthreads;t++)
+				er+=boxpanelhits(sim,pnllist,(int)((long int)npnl*t/nthreads),(int)((long int)npnl*(t+1)/nthreads),&hit[t],&nhit[t]);
+
+			if(!er)
+				for(t=0;t<nthreads && !er;t++)						// box->npanel, which allocates sparse boxes
+					for(p2=0;p2<nhit[t] && !er;p2++) {
+						bptr=addr2box(boxs,hit[t][2*p2+1],1);
+						if(bptr) bptr->npanel++;
+						else er=1; }
+			nbox=boxs->nbox;
+			blist=boxs->blist;
+			for(b=0;b<nbox && !er;b++) {
+				bptr=blist[b];
+				npanel=bptr->npanel;
+				bptr->npanel=0;
+				if(npanel>bptr->maxpanel)
+					er=expandboxpanels(bptr,npanel-bptr->maxpanel); }
+			if(!er)
+				for(t=0;t<nthreads;t++)										// box->panel, in panel order
+					for(p2=0;p2<nhit[t];p2++) {
+						bptr=addr2box(boxs,hit[t][2*p2+1],0);
+						bptr->panel[bptr->npanel++]=pnllist[hit[t][2*p2]]; }
+
+			for(t=0;t<nthreads;t++) free(hit[t]);
+			free(hit);
+			free(nhit);
+			free(pnllist);
+			if(er) return 1; }}
+
+	if(sim->mols && boxs->cellmol) {								// contiguous lists
+		if(sim->mols->condition<SCparams) return 2;
+		for(m=sim->mols->topd;m<sim->mols->nd;m++) {
+			mptr=sim->mols->dead[m];
+			if(mptr->ident>0) mptr->box=pos2box(sim,mptr->pos); }
+		for(ll=0;ll<boxs->nlist;ll++)
+			if(sim->mols->listtype[ll]==MLTsystem)
+				if(boxcellbuild(sim,ll,1)) return 1; }
+
+	else if(sim->mols) {									// mptr->box, box->maxmol, nmol, mol
 		if(sim->mols->condition<SCparams) return 2;
 		for(b=0;b<nbox;b++)									// clear out molecule lists in boxes
 			for(ll=0;ll<boxs->nlist;ll++)
@@ -687,10 +1370,13 @@ int boxesupdateparams(simptr sim) {
 				mptr=mlist[m];
 				if(mptr->ident>0) {
 					bptr=pos2box(sim,mptr->pos);
+					if(!bptr) return 1;
 					mptr->box=bptr;
 					ll=sim->mols->listlookup[mptr->ident][mptr->mstate];
 					bptr->nmol[ll]++; }}}
 
+		nbox=boxs->nbox;														// sparse boxes may have been added
+		blist=boxs->blist;
 		for(b=0;b<nbox;b++) {
 			bptr=blist[b];
 			for(ll=0;ll<boxs->nlist;ll++) {
@@ -708,6 +1394,7 @@ int boxesupdateparams(simptr sim) {
 				if(mptr->ident>0) {
 					ll=sim->mols->listlookup[mptr->ident][mptr->mstate];
 					bptr=mptr->box;
+					mptr->boxm=bptr->nmol[ll];
 					bptr->mol[ll][bptr->nmol[ll]++]=mptr; }}}}
 
 	return 0; }
@@ -715,10 +1402,10 @@ int boxesupdateparams(simptr sim) {
 
 /* boxesupdatelists */
 int boxesupdatelists(simptr sim) {
-	int dim,d,nbox,b,b2,w,er,nneigh,nwall;
-	int *side,*indx;
+	int dim,d,nbox,b,er,ll;
+	int *side;
 	boxssptr boxs;
-	boxptr *blist,bptr;
+	boxptr *blist;
 	double flt1,flt2,mpbox;
 	int *ntemp,*wptemp;
 
@@ -732,11 +1419,16 @@ int boxesupdatelists(simptr sim) {
 	
 	if(sim->mols && sim->mols->condition<SCparams) return 2;
 	if(boxs->blist) {																// box superstructure
+		boxcellfree(boxs);
 		boxesfree(boxs->blist,boxs->nbox,boxs->nlist);
+		boxs->blist=NULL;
 		boxs->nbox=0; }
+	free(boxs->hash);
+	boxs->hash=NULL;
+	boxs->maxhash=0;
 	side=boxs->side;
 	mpbox=boxs->mpbox;
-	if(mpbox<=0 && boxs->boxsize<=0) mpbox=5;
+	if(mpbox<=0 && boxs->boxsize<=0) mpbox=4;			// same default as when no box statements are given
 	if(mpbox>0) {
 		flt1=systemvolume(sim);
 		flt2=(double)molcount(sim,-5,NULL,MSall,-1);
@@ -751,72 +1443,57 @@ int boxesupdatelists(simptr sim) {
 		nbox*=side[d]; }
 	boxs->boxvol=1.0;
 	for(d=0;d<dim;d++) boxs->boxvol*=boxs->size[d];
+	boxedgefree(boxs);
+	if(boxs->adapt)																	// density-adapted widths
+		if(boxadaptedges(sim)) return 1;
 
 	boxs->nlist=sim->mols?sim->mols->nlist:0;					// individual boxes
-	boxs->nbox=nbox;
-	blist=boxs->blist=boxesalloc(nbox,dim,boxs->nlist);
-	if(!blist) return 1;
+	boxs->ngrid=nbox;
+	if(boxs->sparse) {																// sparse boxes are allocated when first used
+		if(!boxs->tmpbox) {
+			boxs->tmpbox=boxalloc(dim,0);
+			if(!boxs->tmpbox) return 1;
+			boxs->tmpbox->boxs=boxs; }
+		boxs->nbox=0;
+		boxs->maxbox=16;
+		blist=boxs->blist=(boxptr*) calloc(boxs->maxbox,sizeof(boxptr));
+		if(!blist) return 1;
+		for(b=0;b<boxs->maxbox;b++) blist[b]=NULL;
+		if(boxrehash(boxs,32)) return 1; }
+	else {
+		boxs->nbox=boxs->maxbox=nbox;
+		blist=boxs->blist=boxesalloc(nbox,dim,boxs->nlist);
+		if(!blist) return 1; }
+
+	if(boxs->cellstore && boxs->nlist) {							// contiguous lists
+		boxs->cellmol=(moleculeptr**) calloc(boxs->nlist,sizeof(moleculeptr*));
+		boxs->maxcellmol=(int*) calloc(boxs->nlist,sizeof(int));
+		if(!boxs->cellmol || !boxs->maxcellmol) return 1;
+		for(ll=0;ll<boxs->nlist;ll++) {
+			boxs->cellmol[ll]=NULL;
+			boxs->maxcellmol[ll]=0; }}
 
-	for(b=0;b<nbox;b++) add2indxZV(b,blist[b]->indx,side,dim);	// box->indx
+	if(boxs->sparse) return 0;												// sparse boxes are set up as they are allocated
+
+	for(b=0;b<nbox;b++) {															// box->boxs, bnum, indx
+		blist[b]->boxs=boxs;
+		blist[b]->bnum=b;
+		add2indxZV(b,blist[b]->indx,side,dim); }
 
 	if(sim->accur>=3) {
 		ntemp=allocZV(intpower(3,dim)-1);								// neigh
 		wptemp=allocZV(intpower(3,dim)-1);
 		if(!ntemp || !wptemp) return 1;
-		for(b=0;b<nbox;b++) {
-			bptr=blist[b];
-			indx=bptr->indx;
-			if(sim->accur<6)
-				nneigh=neighborZV(indx,ntemp,side,dim,0,NULL,&bptr->midneigh);
-			else if(sim->accur<9) {
-				for(w=0;w<2*dim;w++) wptemp[w]=(sim->wlist[w]->type=='p' && sim->srfss==NULL);
-				nneigh=neighborZV(indx,ntemp,side,dim,6,wptemp,&bptr->midneigh); }
-			else {
-				for(w=0;w<2*dim;w++) wptemp[w]=(sim->wlist[w]->type=='p' && sim->srfss==NULL);
-				nneigh=neighborZV(indx,ntemp,side,dim,7,wptemp,&bptr->midneigh); }
-			if(nneigh==-1) return 1;
-			w=0;
-			if(sim->accur>=6) for(b2=0;b2<nneigh;b2++) w+=wptemp[b2];
-
-			if(nneigh && nneigh!=bptr->nneigh) {
-				free(bptr->neigh);
-				free(bptr->wpneigh);
-				bptr->wpneigh=NULL;
-                // See https://gcc.gnu.org/bugzilla/show_bug.cgi?id=85783
-				bptr->neigh=(boxptr*) calloc((unsigned int) nneigh,sizeof(boxptr));
-				if(!bptr->neigh) return 1;
-				if(w) {
-					bptr->wpneigh=allocZV(nneigh);
-					if(!bptr->wpneigh) return 1; }
-				bptr->nneigh=nneigh; }
-			if(nneigh)
-				for(b2=0;b2<nneigh;b2++) bptr->neigh[b2]=blist[ntemp[b2]];
-			if(w) {
-				for(b2=0;b2<nneigh;b2++) bptr->wpneigh[b2]=wptemp[b2]; }}
-		
+		for(b=0;b<nbox;b++)
+			if(boxsetneighbors(sim,blist[b],ntemp,wptemp)) return 1;
 		neighborZV(NULL,NULL,NULL,0,-1,NULL,NULL);
 		freeZV(ntemp);
 		freeZV(wptemp); }
-	
-	for(b=0;b<nbox;b++) {														// box->nwall, wlist
-		bptr=blist[b];
-		indx=bptr->indx;
-		nwall=0;
-		for(d=0;d<dim;d++) {
-			if(indx[d]==0) nwall++;
-			if(indx[d]==side[d]-1) nwall++; }
-		if(nwall && nwall!=bptr->nwall) {
-			free(bptr->wlist);
-			bptr->wlist=(wallptr*) calloc(nwall,sizeof(wallptr));
-			if(!bptr->wlist) return 1;
-			bptr->nwall=nwall; }
-		if(nwall) {
-			w=0;
-			for(d=0;d<dim;d++) {
-				if(indx[d]==0) bptr->wlist[w++]=sim->wlist[2*d];
-				if(indx[d]==side[d]-1) bptr->wlist[w++]=sim->wlist[2*d+1]; }}}
 
-		return 0; }
+	for(b=0;b<nbox;b++)																// box->nwall, wlist
+		if(boxsetwalls(sim,blist[b])) return 1;
+
+	return 0; }
 
 
 /* boxesupdate */
@@ -845,10 +1522,11 @@ int boxesupdate(simptr sim) {
 /* line2nextbox */
 boxptr line2nextbox(simptr sim,double *pt1,double *pt2,boxptr bptr) {
 	int dim,d,d2,boxside,boxside2,adrs,z1[DIMMAX],*side,sum,flag;
-	double *size,*min,crsmin,edge,crs;
+	double *size,*min,**edges,crsmin,edge,crs;
 
 	if(pos2box(sim,pt2)==bptr) return NULL;
 	dim=sim->dim;
+	edges=sim->boxs->edge;
 	size=sim->boxs->size;
 	side=sim->boxs->side;
 	min=sim->boxs->min;
@@ -862,7 +1540,7 @@ boxptr line2nextbox(simptr sim,double *pt1,double *pt2,boxptr bptr) {
 			boxside=(pt2[d]>pt1[d])?1:0;		// 1 for high side, 0 for low side
 			sum=bptr->indx[d]+boxside;
 			if(sum>0 && sum<side[d]) {
-				edge=min[d]+(double)sum*size[d];		// absolute location of potential edge crossing
+				edge=edges?edges[d][sum]:min[d]+(double)sum*size[d];		// absolute location of potential edge crossing
 				crs=(edge-pt1[d])/(pt2[d]-pt1[d]);	// relative position of potential edge crossing on line
 				if(crs<crsmin) {
 					crsmin=crs;
@@ -879,26 +1557,114 @@ boxptr line2nextbox(simptr sim,double *pt1,double *pt2,boxptr bptr) {
 				boxside=(pt2[d]>pt1[d])?1:0;
 				sum=bptr->indx[d]+boxside;
 				if(sum>0 && sum<side[d]) {
-					edge=min[d]+(double)sum*size[d];
+					edge=edges?edges[d][sum]:min[d]+(double)sum*size[d];
 					crs=(edge-pt1[d])/(pt2[d]-pt1[d]);
 					if(crs==crsmin && (boxside==1 || flag==2))
 						z1[d]+=boxside?1:-1; }}}
 		adrs=indx2addZV(z1,sim->boxs->side,dim);
-		return sim->boxs->blist[adrs]; }
+		return addr2box(sim->boxs,adrs,1); }
 
 	if(crsmin==1.01) return NULL;
 	z1[d2]+=boxside2?1:-1;
 	adrs=indx2addZV(z1,sim->boxs->side,dim);
-	return sim->boxs->blist[adrs]; }
+	return addr2box(sim->boxs,adrs,1); }
 
 
-/* reassignmolecs */
-int reassignmolecs(simptr sim,int diffusing,int reborn) {
-	int m,nmol,m2,ll,b,s;
+/* boxcellbuild */
+int boxcellbuild(simptr sim,int ll,int assign) {
+	boxssptr boxs;
+	boxptr *blist,bptr;
+	moleculeptr mptr,*mlist,*cell;
+	int nbox,nmol,nthreads,t,m,b,n,c,k,*ct,total,dim;
+
+	boxs=sim->boxs;
+	dim=sim->dim;
+	mlist=sim->mols->live[ll];
+	nmol=sim->mols->nl[ll];
+	nthreads=sim->nthreads>1?sim->nthreads:1;
+
+	if(assign && boxs->hash) {											// sparse boxes are allocated serially
+		for(m=0;m<nmol;m++)
+			if(mlist[m]) {
+				mlist[m]->box=pos2boxdim(boxs,mlist[m]->pos,dim);
+				if(!mlist[m]->box) return 1; }
+		assign=0; }
+	blist=boxs->blist;
+	nbox=boxs->nbox;
+
+	if(nthreads*nbox>boxs->maxcellct) {							// counts, one set per thread
+		free(boxs->cellct);
+		boxs->maxcellct=0;
+		boxs->cellct=(int*) calloc(nthreads*nbox,sizeof(int));
+		if(!boxs->cellct) return 1;
+		boxs->maxcellct=nthreads*nbox; }
+	ct=boxs->cellct;
+
+#ifdef HAVE_OPENMP
+	#pragma omp parallel for num_threads(nthreads) schedule(static,1) private(m,b,mptr)
+#endif
+	for(t=0;t<nthreads;t++) {											// first pass: count molecules per box
+		for(b=0;b<nbox;b++) ct[t*nbox+b]=0;
+		for(m=(int)((long int)nmol*t/nthreads);m<(int)((long int)nmol*(t+1)/nthreads);m++) {
+			mptr=mlist[m];
+			if(!mptr) continue;
+			if(assign) {
+				b=pos2boxindexdim(boxs,mptr->pos,dim);
+				mptr->box=blist[b]; }
+			else if(mptr->box)
+				b=mptr->box->bnum;
+			else continue;
+			ct[t*nbox+b]++; }}
+
+	total=0;																				// total size, with room for molecules added later
+	for(b=0;b<nbox;b++) {
+		n=0;
+		for(t=0;t<nthreads;t++) n+=ct[t*nbox+b];
+		total+=n+n/2+1; }
+
+	if(total>boxs->maxcellmol[ll]) {								// grow contiguous list if needed
+		free(boxs->cellmol[ll]);
+		boxs->maxcellmol[ll]=0;
+		total+=total/2;
+		boxs->cellmol[ll]=(moleculeptr*) calloc(total,sizeof(moleculeptr));
+		if(!boxs->cellmol[ll]) return 1;
+		boxs->maxcellmol[ll]=total; }
+
+	cell=boxs->cellmol[ll];													// prefix sums give box segments and thread offsets
+	for(b=0;b<nbox;b++) {
+		n=0;
+		for(t=0;t<nthreads;t++) {
+			c=ct[t*nbox+b];
+			ct[t*nbox+b]=n;
+			n+=c; }
+		bptr=blist[b];
+		bptr->nmol[ll]=n;
+		bptr->mol[ll]=cell;
+		bptr->maxmol[ll]=n+n/2+1;
+		cell+=n+n/2+1; }
+
+#ifdef HAVE_OPENMP
+	#pragma omp parallel for num_threads(nthreads) schedule(static,1) private(m,b,k,mptr)
+#endif
+	for(t=0;t<nthreads;t++)												// second pass: scatter molecules
+		for(m=(int)((long int)nmol*t/nthreads);m<(int)((long int)nmol*(t+1)/nthreads);m++) {
+			mptr=mlist[m];
+			if(!mptr || !mptr->box) continue;
+			b=mptr->box->bnum;
+			k=ct[t*nbox+b]++;
+			mptr->box->mol[ll][k]=mptr;
+			mptr->boxm=k; }
+
+	return 0; }
+
+
+/* reassignmolecsdim */
+static inline int reassignmolecsdim(simptr sim,int diffusing,int reborn,const int dim) {
+	int m,nmol,ll,b,s;
 	boxptr bptr1;
 	boxssptr boxss;
 	surfacessptr srfss;
-	moleculeptr mptr,*mlist,*mlist2;
+	moleculeptr mptr,*mlist;
 	surfaceptr srf;
 
 	if(!sim->mols) return 0;
@@ -908,7 +1674,22 @@ int reassignmolecs(simptr sim,int diffusing,int reborn) {
 	if(!reborn) {						// all molecules
 		for(ll=0;ll<sim->mols->nlist;ll++)
 			if(sim->mols->listtype[ll]==MLTsystem)
-				if(diffusing==0 || sim->mols->diffuselist[ll]==1) {
+				if(diffusing==0 || (sim->mols->diffuselist[ll] && mollistmoves(sim->mols,ll))) {
+					if(boxss->cellmol) {								// contiguous lists
+						if(boxcellbuild(sim,ll,1)) return 1;
+						if(srfss) {
+							for(s=0;s<srfss->nsrf;s++)
+								srfss->srflist[s]->nmol[ll]=0;
+							nmol=sim->mols->nl[ll];
+							mlist=sim->mols->live[ll];
+							for(m=0;m<nmol;m++) {
+								mptr=mlist[m];
+								if(mptr->pnl) {
+									srf=mptr->pnl->srf;
+									if(srf->nmol[ll]==srf->maxmol[ll])
+										if(surfexpandmollist(srf,2*srf->nmol[ll]+1,ll)) return 1;
+									srf->mol[ll][srf->nmol[ll]++]=mptr; }}}
+						continue; }
 					for(b=0;b<boxss->nbox;b++)				// clear out box list
 						boxss->blist[b]->nmol[ll]=0;
 					if(srfss)
@@ -918,10 +1699,11 @@ int reassignmolecs(simptr sim,int diffusing,int reborn) {
 					mlist=sim->mols->live[ll];
 					for(m=0;m<nmol;m++) {
 						mptr=mlist[m];
-						bptr1=pos2box(sim,mptr->pos);
+						bptr1=pos2boxdim(boxss,mptr->pos,dim);
 						mptr->box=bptr1;								// add to new box
 						if(bptr1->nmol[ll]==bptr1->maxmol[ll])
 							if(expandbox(bptr1,1+bptr1->nmol[ll],ll)) return 1;
+						mptr->boxm=bptr1->nmol[ll];
 						bptr1->mol[ll][bptr1->nmol[ll]++]=mptr;
 						if(mptr->pnl) {									// add to surface
 							srf=mptr->pnl->srf;
@@ -932,20 +1714,16 @@ int reassignmolecs(simptr sim,int diffusing,int reborn) {
 	else {										// reborn molecules only
 		for(ll=0;ll<sim->mols->nlist;ll++)
 			if(sim->mols->listtype[ll]==MLTsystem)
-				if(diffusing==0 || sim->mols->diffuselist[ll]==1) {
+				if(diffusing==0 || sim->mols->diffuselist[ll]) {
 					nmol=sim->mols->nl[ll];
 					mlist=sim->mols->live[ll];
 					for(m=sim->mols->topl[ll];m<nmol;m++) {
 						mptr=mlist[m];
-						bptr1=pos2box(sim,mptr->pos);
+						bptr1=pos2boxdim(boxss,mptr->pos,dim);
 						if(mptr->box!=bptr1) {
-							mlist2=mptr->box->mol[ll];		// remove from current box
-							for(m2=0;mlist2[m2]!=mptr;m2++);
-							mlist2[m2]=mlist2[--mptr->box->nmol[ll]];
+							boxremovemol(mptr,ll);					// remove from current box
 							mptr->box=bptr1;								// add to new box
-							if(bptr1->nmol[ll]==bptr1->maxmol[ll])
-								if(expandbox(bptr1,1+bptr1->nmol[ll],ll)) return 1;
-							bptr1->mol[ll][bptr1->nmol[ll]++]=mptr; }
+							if(boxaddmol(mptr,ll)) return 1; }
 						if(mptr->pnl) {									// add to surface
 							srf=mptr->pnl->srf;						// there is no check for prior listing on a surface because that is impossible
 							if(srf->nmol[ll]==srf->maxmol[ll])
@@ -954,4 +1732,66 @@ int reassignmolecs(simptr sim,int diffusing,int reborn) {
 	return 0; }
 
 
+/* reassignmolecs */
+int reassignmolecs(simptr sim,int diffusing,int reborn) {
+	return reassignmolecsdim(sim,diffusing,reborn,sim->dim); }
+
+
+/* reassignmolecs1D */
+int reassignmolecs1D(simptr sim,int diffusing,int reborn) {
+	return reassignmolecsdim(sim,diffusing,reborn,1); }
+
+
+/* reassignmolecs2D */
+int reassignmolecs2D(simptr sim,int diffusing,int reborn) {
+	return reassignmolecsdim(sim,diffusing,reborn,2); }
+
+
+/* reassignmolecs3D */
+int reassignmolecs3D(simptr sim,int diffusing,int reborn) {
+	return reassignmolecsdim(sim,diffusing,reborn,3); }
 
+
+/* boxesautotune */
+int boxesautotune(simptr sim,double cost) {
+	boxssptr boxs;
+	int k,p,best,center;
+	double nmol,width;
+
+	boxs=sim->boxs;
+	if(!boxs || !boxs->tunesteps) return 0;
+	center=BOXTUNE/2;
+
+	if(boxs->tunecand<0) {													// not tuning, so check for density change
+		if(++boxs->tunect<boxs->tunesteps) return 0;
+		boxs->tunect=0;
+		nmol=(double)molcount(sim,-5,NULL,MSall,-1);
+		if(boxs->tunenmol>=0 && fabs(nmol-boxs->tunenmol)<=boxs->tunethresh*boxs->tunenmol) return 0;
+		boxs->tunenmol=nmol;
+		width=boxs->size[0];
+		for(k=1;k<sim->dim;k++)
+			if(boxs->size[k]>width) width=boxs->size[k];
+		boxs->tuneround=0;
+		boxtunecandidates(sim,width);
+		boxtunenext(sim,0);
+		return 0; }
+
+	k=boxs->tunecand;																// sampling a candidate
+	p=k<=center?center-k:k;
+	boxs->tunecost[k]+=cost;
+	best=boxtunebest(boxs,p);
+	if(++boxs->tunect<boxs->tunesteps && !(best>=0 && boxs->tunecost[k]>boxs->tunecost[best])) return 0;
+	if(boxtunenext(sim,p+1)) return 0;
+
+	best=boxtunebest(boxs,BOXTUNE);									// all candidates sampled, so pick best
+	if(best<0) return 0;
+	width=boxs->tunewidth[best];
+	boxs->tuneround++;
+	if((best==0 || best==BOXTUNE-1) && boxs->tuneround<4) {	// best is at edge of range, so keep looking
+		cost=boxs->tunecost[best];
+		boxtunecandidates(sim,width);
+		boxs->tunecost[center]=cost;									// center was already sampled
+		if(boxs->tunewidth[center]>0 && boxtunenext(sim,1)) return 0; }
+	boxsettunewidth(sim,width);
+	simLog(sim,2," Virtual box width autotuned to %g|L\n",width);
+	return 0; }
@@ -386,16 +386,18 @@ enum CMDcode cmdsetflag(simptr sim,cmdptr cmd,char *line2) {
 
 /* cmdsetrandseed */
 enum CMDcode cmdsetrandseed(simptr sim,cmdptr cmd,char *line2) {
-	int itct;
+	int itct,t;
 	long int seed;
 
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDcontrol;
-	(void)sim;
 	SCMDCHECK(line2,"missing argument");
 	itct=sscanf(line2,"%li",&seed);
 	SCMDCHECK(itct==1,"cannot read seed");
-	if(seed<0) randomize((long int) time(NULL));
+	if(seed<0) seed=randomize((long int) time(NULL));
 	else randomize((long int) seed);
+	if(sim->threadrng)																// reseed thread random number streams
+		for(t=0;t<sim->nthreads;t++)
+			randstreaminit(sim->threadrng+4*t,(uint64_t)seed,t);
 	return CMDok; }
 
 
@@ -847,12 +849,9 @@ enum CMDcode cmdmolcountheader(simptr sim,cmdptr cmd,char *line2) {
 /* cmdmolcount */
 enum CMDcode cmdmolcount(simptr sim,cmdptr cmd,char *line2) {
 	FILE *fptr;
-	int i,nspecies,*ctlat,ilat,er,dataid;
+	int i,nspecies,*ctlat,ilat,er,dataid,*ct;
 	latticeptr lat;
-	moleculeptr mptr;
-	static int inscan=0,*ct=NULL;
 
-	if(inscan) goto scanportion;
 	if(line2 && !strcmp(line2,"cmdtype")) return CMDobserve;
 
 	SCMDCHECK(cmd->i1!=-1,"error on setup");					// failed before, don't try again
@@ -869,11 +868,8 @@ enum CMDcode cmdmolcount(simptr sim,cmdptr cmd,char *line2) {
 		if(!cmd->v1) {cmd->i1=-1;return CMDwarn;} }
 
 	ct=(int*)cmd->v1;
-	for(i=0;i<nspecies;i++) ct[i]=0;									// clear counters
-
-	inscan=1;
-	molscancmd(sim,-1,NULL,MSall,cmd,cmdmolcount);
-	inscan=0;
+	ct[0]=0;
+	for(i=1;i<nspecies;i++) ct[i]=molcount(sim,i,NULL,MSall,-1);
 
 	if(sim->latticess) {
     if(cmd->i2!=nspecies) {
@@ -901,11 +897,6 @@ enum CMDcode cmdmolcount(simptr sim,cmdptr cmd,char *line2) {
 		scmdappenddata(cmd->cmds,dataid,0,1,(double)ct[i]); }
 	scmdfprintf(cmd->cmds,fptr,"\n");
 	scmdflush(fptr);
-	return CMDok;
-
- scanportion:
-	mptr=(moleculeptr) line2;
-	ct[mptr->ident]++;
 	return CMDok; }
 
 
@@ -934,6 +925,10 @@ double fnmolcount(void *voidsim,char *erstr,char *line2) {
 	SFNCHECK(i!=-4 || sim->ruless,"molecule name not recognized");
 	SFNCHECK(i!=-7,"error allocating memory");
 
+	if(i!=0) {
+		ct=(i==-4)?0:molcount(sim,i,NULL,ms,-1);
+		return ct; }
+
 	ct=0;
 	inscan=1;
 	molscanfn(sim,i,index,ms,erstr,fnmolcount);
@@ -4134,7 +4129,8 @@ enum CMDcode cmdreplacevolmol(simptr sim,cmdptr cmd,char *line2) {
 	b2=indx2addZV(bptr2->indx,boxs->side,dim);
 	ll=sim->mols->listlookup[i1][ms1];
 	for(b=b1;b<=b2;b=nextaddZV(b,bptr1->indx,bptr2->indx,boxs->side,dim)) {
-		bptr=boxs->blist[b];
+		bptr=addr2box(boxs,b,0);
+		if(!bptr) continue;									// unallocated sparse boxes are empty
 		mlist=bptr->mol[ll];
 		for(m=0;m<bptr->nmol[ll];m++) {
 			mptr=mlist[m];
@@ -4357,8 +4353,9 @@ enum CMDcode cmdshufflemollist(simptr sim,cmdptr cmd,char *line2) {
 		SCMDCHECK(ll>=0,"list name not recognized"); }
 	lllo=(ll==-1)?0:ll;
 	llhi=(ll==-1)?sim->mols->nlist:ll+1;
-	for(ll=lllo;ll<llhi;ll++)
+	for(ll=lllo;ll<llhi;ll++) {
 		randshuffletableV((void**) sim->mols->live[ll],sim->mols->nl[ll]);
+		SCMDCHECK(!molstoresync(sim->mols,ll),"error allocating memory"); }
 	return CMDok; }
 
 
@@ -4457,7 +4454,8 @@ enum CMDcode cmdexcludebox(simptr sim,cmdptr cmd,char *line2) {
 	b1=indx2addZV(bptr1->indx,boxs->side,dim);
 	b2=indx2addZV(bptr2->indx,boxs->side,dim);
 	for(b=b1;b<=b2;b=nextaddZV(b,bptr1->indx,bptr2->indx,boxs->side,dim)) {
-		bptr=boxs->blist[b];
+		bptr=addr2box(boxs,b,0);
+		if(!bptr) continue;									// unallocated sparse boxes are empty
 		mlist=bptr->mol[0];
 		for(m=0;m<bptr->nmol[0];m++) {
 			pos=mlist[m]->pos;
@@ -4501,7 +4499,8 @@ enum CMDcode cmdexcludesphere(simptr sim,cmdptr cmd,char *line2) {
 	b1=indx2addZV(bptr1->indx,boxs->side,dim);
 	b2=indx2addZV(bptr2->indx,boxs->side,dim);
 	for(b=b1;b<=b2;b=nextaddZV(b,bptr1->indx,bptr2->indx,boxs->side,dim)) {
-		bptr=boxs->blist[b];
+		bptr=addr2box(boxs,b,0);
+		if(!bptr) continue;									// unallocated sparse boxes are empty
 		mlist=bptr->mol[0];
 		for(m=0;m<bptr->nmol[0];m++) {
 			pos=mlist[m]->pos;
@@ -700,7 +700,7 @@ int compartaddcmptl(compartptr cmpt,compartptr cmptl,enum CmptLogic sym) {
 int compartupdatebox(simptr sim,compartptr cmpt,boxptr bptr,double volfrac) {
 	int ptsmax=100;	// number of random points for volume determination
 	int bc,max,ptsin,i,bc2;
-	double pos[DIMMAX],volfrac2,*newboxfrac,*newcumboxvol,boxvol,vol;
+	double pos[DIMMAX],volfrac2,*newboxfrac,*newcumboxvol,vol;
 	boxptr *newboxlist;
 
 	newboxlist=NULL;
@@ -727,10 +727,9 @@ int compartupdatebox(simptr sim,compartptr cmpt,boxptr bptr,double volfrac) {
 			return 2; }																	// last box was removed
 		cmpt->boxlist[bc]=cmpt->boxlist[cmpt->nbox];
 		cmpt->boxfrac[bc]=cmpt->boxfrac[cmpt->nbox];
-		boxvol=sim->boxs->boxvol;
 		vol=(bc==0)?0:cmpt->cumboxvol[bc-1];
 		for(bc2=bc;bc2<cmpt->nbox;bc2++) {
-			vol+=boxvol*cmpt->boxfrac[bc2];
+			vol+=boxvolume(sim,cmpt->boxlist[bc2])*cmpt->boxfrac[bc2];
 			cmpt->cumboxvol[bc2]=vol; }
 		cmpt->volume=vol;
 		return 2; }
@@ -738,10 +737,9 @@ int compartupdatebox(simptr sim,compartptr cmpt,boxptr bptr,double volfrac) {
 	if(bc<cmpt->nbox) {															// box was listed, so just update volume
 		if(cmpt->boxfrac[bc]==volfrac2) return 0;			// volume was ok, so return
 		cmpt->boxfrac[bc]=volfrac2;										// volume not ok, so update it
-		boxvol=sim->boxs->boxvol;
 		vol=(bc==0)?0:cmpt->cumboxvol[bc-1];
 		for(bc2=bc;bc2<cmpt->nbox;bc2++) {
-			vol+=boxvol*cmpt->boxfrac[bc2];
+			vol+=boxvolume(sim,cmpt->boxlist[bc2])*cmpt->boxfrac[bc2];
 			cmpt->cumboxvol[bc2]=vol; }
 		cmpt->volume=vol;
 		return 3; }
@@ -770,7 +768,7 @@ int compartupdatebox(simptr sim,compartptr cmpt,boxptr bptr,double volfrac) {
 	bc=cmpt->nbox++;								// put box into cmpt
 	cmpt->boxlist[bc]=bptr;
 	cmpt->boxfrac[bc]=volfrac2;
-	cmpt->volume+=sim->boxs->boxvol*cmpt->boxfrac[bc];
+	cmpt->volume+=boxvolume(sim,bptr)*cmpt->boxfrac[bc];
 	cmpt->cumboxvol[bc]=cmpt->volume;
 	return 1;
 
@@ -788,7 +786,7 @@ int compartupdatebox(simptr sim,compartptr cmpt,boxptr bptr,double volfrac) {
 int compartupdatebox_volumeSample(simptr sim,compartptr cmpt,boxptr bptr,double volfrac) {
 	/*int ptsmax=100;*/	// number of random points for volume determination
 	int bc,max,bc2;
-	double volfrac2,*newboxfrac,*newcumboxvol,boxvol,vol;
+	double volfrac2,*newboxfrac,*newcumboxvol,vol;
 	boxptr *newboxlist;
 
 	newboxlist=NULL;
@@ -809,10 +807,9 @@ int compartupdatebox_volumeSample(simptr sim,compartptr cmpt,boxptr bptr,double
 			return 2; }																	// last box was removed
 		cmpt->boxlist[bc]=cmpt->boxlist[cmpt->nbox];
 		cmpt->boxfrac[bc]=cmpt->boxfrac[cmpt->nbox];
-		boxvol=sim->boxs->boxvol;
 		vol=(bc==0)?0:cmpt->cumboxvol[bc-1];
 		for(bc2=bc;bc2<cmpt->nbox;bc2++) {
-			vol+=boxvol*cmpt->boxfrac[bc2];
+			vol+=boxvolume(sim,cmpt->boxlist[bc2])*cmpt->boxfrac[bc2];
 			cmpt->cumboxvol[bc2]=vol; }
 		cmpt->volume=vol;
 		return 2; }
@@ -820,10 +817,9 @@ int compartupdatebox_volumeSample(simptr sim,compartptr cmpt,boxptr bptr,double
 	if(bc<cmpt->nbox) {													// box was listed, so just update volume
 		if(cmpt->boxfrac[bc]==volfrac2) return 0;			// volume was ok, so return
 		cmpt->boxfrac[bc]=volfrac2;										// volume not ok, so update it
-		boxvol=sim->boxs->boxvol;
 		vol=(bc==0)?0:cmpt->cumboxvol[bc-1];
 		for(bc2=bc;bc2<cmpt->nbox;bc2++) {
-			vol+=boxvol*cmpt->boxfrac[bc2];
+			vol+=boxvolume(sim,cmpt->boxlist[bc2])*cmpt->boxfrac[bc2];
 			cmpt->cumboxvol[bc2]=vol; }
 		cmpt->volume=vol;
 		return 3; }
@@ -852,7 +848,7 @@ int compartupdatebox_volumeSample(simptr sim,compartptr cmpt,boxptr bptr,double
 	bc=cmpt->nbox++;								// put box into cmpt
 	cmpt->boxlist[bc]=bptr;
 	cmpt->boxfrac[bc]=volfrac2;
-	cmpt->volume+=sim->boxs->boxvol*cmpt->boxfrac[bc];
+	cmpt->volume+=boxvolume(sim,bptr)*cmpt->boxfrac[bc];
 	cmpt->cumboxvol[bc]=cmpt->volume;
 	return 1;
 
@@ -999,14 +995,15 @@ int compartsupdateparams_original(simptr sim) {
 
 	cmptss=sim->cmptss;
 	boxs=sim->boxs;
-	if(!boxs || !boxs->nbox) return 2;
+	if(!boxs || !boxs->ngrid) return 2;
 
 	for(c=0;c<cmptss->ncmpt;c++) {
 		cmpt=cmptss->cmptlist[c];
 		cmpt->nbox=0;
+		cmpt->volume=0;
 
-		for(b=0;b<boxs->nbox;b++) {											// find boxes that are in the compartment
-			bptr=boxs->blist[b];
+		for(b=0;b<boxs->ngrid;b++) {										// find boxes that are in the compartment
+			bptr=addr2box(boxs,b,2);
 			inbox=0;
 			for(p=0;p<bptr->npanel && !inbox;p++) {
 				srf=bptr->panel[p]->srf;
@@ -1015,6 +1012,9 @@ int compartsupdateparams_original(simptr sim) {
 			if(!inbox && cmpt->ncmptl==0) {
 				boxrandpos(sim,pos,bptr);
 				if(posincompart(sim,pos,cmpt,0)) inbox=2; }		// compartment contains whole box
+			if(inbox && bptr==boxs->tmpbox) {
+				bptr=addr2box(boxs,b,1);											// allocate sparse box
+				if(!bptr) return 1; }
 			if(inbox) {
 				er=compartupdatebox(sim,cmpt,bptr,inbox==2?1:-1);
 				if(er==-1) return 1; }}
@@ -1027,8 +1027,9 @@ int compartsupdateparams_original(simptr sim) {
 					er=compartupdatebox(sim,cmpt,bptr,-2);
 					if(er==-1) return 1; }
 			else if(clsym==CLequalnot || clsym==CLornot)
-				for(b=0;b<boxs->nbox;b++) {
-					bptr=boxs->blist[b];
+				for(b=0;b<boxs->ngrid;b++) {
+					bptr=addr2box(boxs,b,1);
+					if(!bptr) return 1;
 					er=compartupdatebox(sim,cmpt,bptr,-2); }}}
 
 	return 0; }
@@ -1038,17 +1039,15 @@ int compartsupdateparams_original(simptr sim) {
 /* compartsupdateparams_volumeSample */
 int compartsupdateparams_volumeSample(simptr sim) {					//VCELL
 	//indecies
-	int b,c,d,i,j,k,cl;
+	int b,c,i,j,k,cl;
 	//varibles used to check possible boxes and its volFrac in a specific compartment
 	double boxLow[3], boxHigh[3], sampleLow[3], sampleHigh[3];
 
 	int dim = sim->dim;
-	double* min = sim->boxs->min; // get origin in the space
-	double* size = sim->boxs->size; //get box x,y,z size
 	VolumeSamples* volumeSample = sim->volumeSamplesPtr;
 	compartssptr cmptss = sim->cmptss;
 	boxssptr boxs = sim->boxs;
-	if(!boxs || !boxs->nbox) return 2;
+	if(!boxs || !boxs->ngrid) return 2;
 
 	double sampleDz = 1;
 	if(dim > 2){
@@ -1067,10 +1066,11 @@ int compartsupdateparams_volumeSample(simptr sim) {					//VCELL
 	for(c=0;c<cmptss->ncmpt;c++) {
 		compartptr cmpt=cmptss->cmptlist[c];
 		cmpt->nbox=0;
+		cmpt->volume=0;
 		unsigned char cmptID = getCompartmentID(cmpt->cname, sim->volumeSamplesPtr);
 		
-		for(b=0;b<boxs->nbox;b++) {											// find boxes that are in the compartment
-			boxptr bptr=boxs->blist[b];
+		for(b=0;b<boxs->ngrid;b++) {										// find boxes that are in the compartment
+			boxptr bptr=addr2box(boxs,b,2);
 			
 			inbox=0;
 			for(p=0;p<bptr->npanel && !inbox;p++) {
@@ -1089,10 +1089,7 @@ int compartsupdateparams_volumeSample(simptr sim) {					//VCELL
 				if(posincompart(sim,pos,cmpt,0)) inbox=2; }
 
 			//finding box low point and high point's indexes in volume sample values.
-			for(d=0;d<dim;d++){
-				boxLow[d] = min[d]+size[d]*bptr->indx[d];
-				boxHigh[d] = min[d]+size[d]*(bptr->indx[d]+1);
-			}
+			box2pos(sim,bptr,boxLow,boxHigh);
 			
 			//initialize varibles used for each box
 			double insideCmptVol = 0;
@@ -1133,9 +1130,12 @@ int compartsupdateparams_volumeSample(simptr sim) {					//VCELL
 					}
 				}
 			}
-			double boxVolfrac = insideCmptVol/((boxs->size[0])*(boxs->size[1])*(boxs->size[2]));
+			double boxVolfrac = insideCmptVol/boxvolume(sim,bptr);
 			if(boxVolfrac <= 1e-8) boxVolfrac = 0; // volume fraction is too small, consider it as 0
 			if((boxVolfrac + 1e-8) >= 1) boxVolfrac = 1; //if volume fraction is almost 1, consider it as 1 
+			if(boxVolfrac > 0 && bptr==boxs->tmpbox) {
+				bptr=addr2box(boxs,b,1);										// allocate sparse box
+				if(!bptr) return 1; }
 			if(boxVolfrac > 0)
 			{
 				int errorCode = compartupdatebox_volumeSample(sim,cmpt,bptr,boxVolfrac);
@@ -1151,8 +1151,9 @@ int compartsupdateparams_volumeSample(simptr sim) {					//VCELL
 					int er=compartupdatebox_volumeSample(sim,cmpt,bptr,-2);
 					if(er==-1) return 1; }
 			else if(clsym==CLequalnot || CLornot)
-				for(b=0;b<boxs->nbox;b++) {
-					boxptr bptr=boxs->blist[b];
+				for(b=0;b<boxs->ngrid;b++) {
+					boxptr bptr=addr2box(boxs,b,1);
+					if(!bptr) return 1;
 					int er=compartupdatebox_volumeSample(sim,cmpt,bptr,-2);
 					if(er==-1) return 1; }
 		}
@@ -23,6 +23,7 @@
 #define UNUSED(x)  (void)(x)
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
@@ -248,6 +249,7 @@ typedef struct NextSubvolumeMethod NextSubvolumeMethod;
 
 #define MSMAX 5
 #define MSMAX1 6
+#define MOLSLABALIGN 64 // byte alignment of molecule memory slabs
 enum MolecState
 {
     MSsoln,
@@ -266,6 +268,17 @@ enum MolListType
     MLTport,
     MLTnone
 };
+enum MolOrder
+{
+    MOnone,
+    MObox,
+    MOmorton
+};
+enum MolGauss
+{
+    MGtable,
+    MGziggurat
+};
 #define PDMAX 6
 enum PatternData
 {
@@ -288,10 +301,18 @@ typedef struct moleculestruct
     int ident;                // species of molecule; 0 is empty (i)
     enum MolecState mstate;   // physical state of molecule (ms)
     struct boxstruct* box;    // pointer to box which molecule is in
+    int boxm;                 // index of molecule in box list (mb)
     struct panelstruct* pnl;  // panel that molecule is bound to if any
     struct panelstruct* pnlx; // old panel that molecule was bound to if any
 } * moleculeptr;
 
+typedef struct molstorestruct
+{
+    int maxm;     // allocated number of molecule slots
+    double* pos;  // contiguous positions [m*dim+d]
+    double* posx; // contiguous old positions [m*dim+d]
+} * molstoreptr;
+
 typedef struct molsuperstruct
 {
     enum StructCond condition;  // structure condition
@@ -307,11 +328,14 @@ typedef struct molsuperstruct
     double** difc;              // diffusion constants [i][ms]
     double** difstep;           // rms diffusion step [i][ms]
     double*** difm;             // diffusion matrix [i][ms][d]
+    double*** difmstep;         // difm times sqrt(2 dt) [i][ms][d]
     double*** drift;            // drift vector [i][ms][d]
     double***** surfdrift;      // surface drift [i][ms][s][ps][d]
     double** display;           // display size of molecule [i][ms]
     double*** color;            // RGB color vector [i][ms]
     int** exist;                // flag for if molecule could exist [i][ms]
+    int** count;                // number of existing molecules [i][ms]
+    int** mobile;               // flag for if molecule can move [i][ms]
     moleculeptr* dead;          // list of dead molecules [m]
     int maxdlimit;              // maximum allowed size of dead list
     int maxd;                   // size of dead molecule list
@@ -327,12 +351,24 @@ typedef struct molsuperstruct
     int* nl;                    // number of molecules in live lists [ll]
     int* topl;                  // live list index; above are reborn [ll]
     int* sortl;                 // live list index; above need sorting [ll]
-    int* diffuselist;           // 1 if any listed molecs diffuse [ll]
+    int* diffuselist;           // 1 all, 2 some, 0 no listed molecs diffuse [ll]
+    int* stepmult;              // time steps per diffusion step [ll]
+    long int stepct;            // time step counter for stepmult
     unsigned long serno;        // serial number for next resurrected molec.
     int ngausstbl;              // number of elements in gausstbl
     double* gausstbl;           // random numbers for diffusion
+    enum MolGauss gaussmethod;  // source of Gaussian random numbers
     int* expand;                // expansion with rule-based modeling [i]
     long int touch;             // counter for molecule modification
+    int molstore;               // 1 if coordinates are kept in list stores
+    molstoreptr deadstore;      // coordinate store for dead list
+    molstoreptr* livestore;     // coordinate stores for live lists [ll]
+    enum MolOrder order;        // method for spatial reordering of live lists
+    int orderinterval;          // time steps between live list reorderings
+    int orderct;                // time steps since last reordering
+    int maxslab;                // allocated size of slab list
+    int nslab;                  // number of memory slabs
+    void** slab;                // memory slabs for molecules [k]
 } * molssptr;
 
 /*********************************** Walls **********************************/
@@ -564,6 +600,8 @@ typedef struct panelstruct
     int maxneigh;                 // maximum number of neighbor panels
     int nneigh;                   // number of neighbor panels
     struct panelstruct** neigh;   // list of neighbor panels [p]
+    struct panelstruct* edgeneigh[3]; // neighbor across triangle edge [k]
+    int edgeneighside[3];         // edge of edgeneigh; -1 none, -2 other [k]
     double* emitterabsorb[2];     // absorption for emitters [face][i]
 } * panelptr;
 
@@ -613,6 +651,7 @@ typedef struct surfacesuperstruct
     double epsilon;            // max deviation of surface-point from surface
     double margin;             // panel margin away from edge
     double neighdist;          // neighbor distance value
+    int localdiffuse;          // 1 for panel-local surface-bound diffusion
     char** snames;             // surface names [s]
     surfaceptr* srflist;       // list of surfaces [s]
     int maxmollist;            // number of molecule lists allocated
@@ -622,6 +661,8 @@ typedef struct surfacesuperstruct
 
 /*********************************** Boxes **********************************/
 
+#define BOXTUNE 5 // number of box widths sampled per autotuning round
+
 typedef struct boxstruct
 {
     int* indx;                // dim dimensional index of the box [d]
@@ -637,6 +678,8 @@ typedef struct boxstruct
     int* maxmol;              // allocated size of live lists [ll]
     int* nmol;                // number of molecules in live lists [ll]
     moleculeptr** mol;        // lists of live molecules in the box [ll][m]
+    struct boxsuperstruct* boxs; // box superstructure
+    int bnum;                 // index of box in superstructure blist
 } * boxptr;
 
 typedef struct boxsuperstruct
@@ -646,11 +689,33 @@ typedef struct boxsuperstruct
     int nlist;                 // copy of number of molecule lists
     double mpbox;              // requested number of molecules per box
     double boxsize;            // requested box width
+    int tunesteps;             // steps per autotune sample, 0 if off
+    double tunethresh;         // relative molecule change for retuning
+    int tunecand;              // candidate being sampled, -1 if none
+    int tunect;                // steps sampled for current candidate
+    int tuneround;             // number of rounds in current tuning
+    double tunenmol;           // molecule number at last tuning
+    double tunewidth[BOXTUNE]; // candidate box widths [k]
+    double tunecost[BOXTUNE];  // summed cost for each candidate [k]
+    int cellstore;             // 1 for contiguous box molecule lists
+    moleculeptr** cellmol;     // contiguous box molecule lists [ll][m]
+    int* maxcellmol;           // allocated size of cellmol lists [ll]
+    int maxcellct;             // allocated size of cellct
+    int* cellct;               // counts for building cellmol [t*nbox+b]
     double boxvol;             // actual box volumes
-    int nbox;                  // total number of boxes
+    int nbox;                  // number of boxes in blist
+    int ngrid;                 // total number of boxes in the grid
     int* side;                 // number of boxes on each side of space
     double* min;               // position vector for low corner of space
     double* size;              // length of each side of a box
+    int adapt;                 // 1 for density-adapted box widths
+    double adaptrad;           // binding radius used for adapted widths
+    double** edge;             // box edges if adapted [d][i], else NULL
+    int sparse;                // 1 for boxes allocated on first use
+    int maxbox;                // allocated size of blist
+    int maxhash;               // size of box hash table, 0 if not sparse
+    int* hash;                 // box address and blist index pairs [2*h]
+    boxptr tmpbox;             // unlisted box for unallocated addresses
     boxptr* blist;             // actual array of boxes
 } * boxssptr;
 
@@ -1035,6 +1100,8 @@ typedef struct simstruct
     time_t clockstt;           // clock starting time of simulation
     double elapsedtime;        // elapsed time of simulation
     long int randseed;         // random number generator seed
+    int nthreads;              // number of threads for diffusion
+    uint64_t* threadrng;       // random number streams for threads [4*t]
     int eventcount[ETMAX];     // counter for simulation events
     int maxvar;                // allocated user-settable variables
     int nvar;                  // number of user-settable variables
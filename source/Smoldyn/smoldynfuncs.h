@@ -59,6 +59,10 @@ extern int VCellDefined;
 // enumerated type functions
 enum MolecState molstring2ms(char *string);
 char *molms2string(enum MolecState ms,char *string);
+enum MolOrder molstring2order(char *string);
+char *molorder2string(enum MolOrder order,char *string);
+enum MolGauss molstring2gauss(char *string);
+char *molgauss2string(enum MolGauss method,char *string);
 
 // low level utilities
 char *molserno2string(unsigned long long serno,char *string);
@@ -73,6 +77,7 @@ int moladdspeciesgroup(simptr sim,const char *group,char *species,int imol);
 
 // set structure values
 int molssetgausstable(simptr sim,int size);
+int molsetgaussmethod(simptr sim,enum MolGauss method);
 void molsetdifc(simptr sim,int ident,int *index,enum MolecState ms,double difc);
 int molsetdifm(simptr sim,int ident,int *index,enum MolecState ms,double *difm);
 int molsetdrift(simptr sim,int ident,int *index,enum MolecState ms,double *drift);
@@ -86,10 +91,13 @@ void molscancmd(simptr sim,int i,int *index,enum MolecState ms,cmdptr cmd,enum C
 void molscanfn(simptr sim,int i,int *index,enum MolecState ms,char *erstr,double(*fn)(void*,char*,char*));
 int molismatch(moleculeptr mptr,int i,int *index,enum MolecState ms);
 double MolCalcDifcSum(simptr sim,int i1,enum MolecState ms1,int i2,enum MolecState ms2);
+int molpairstepmult(simptr sim,int i1,enum MolecState ms1,int i2,enum MolecState ms2);
+int mollistmoves(molssptr mols,int ll);
 
 // memory management
 void molssfree(molssptr mols,int maxsrf);
 int molexpandsurfdrift(simptr sim,int oldmaxspec,int oldmaxsrf);
+int molstoresync(molssptr mols,int ll);
 
 // data structure output
 void molssoutput(simptr sim);
@@ -102,6 +110,9 @@ int molenablemols(simptr sim,int maxspecies);
 void molsetcondition(molssptr mols,enum StructCond cond,int upgrade);
 int addmollist(simptr sim,const char *nm,enum MolListType mlt);
 int molsetmaxmol(simptr sim,int max);
+int molsetstore(simptr sim,int store);
+int molsetorder(simptr sim,enum MolOrder order,int interval);
+int molsetliststep(simptr sim,int ll,int mult);
 int moladdspecies(simptr sim,const char *nm);
 int molsetexpansionflag(simptr sim,int i,int flag);
 int molsupdate(simptr sim);
@@ -109,6 +120,7 @@ int molsupdate(simptr sim);
 // adding and removing molecules
 void molkill(simptr sim,moleculeptr mptr,int ll,int m);
 moleculeptr getnextmol(molssptr mols);
+void molcountadd(molssptr mols,moleculeptr mptr);
 int addmol(simptr sim,int nmol,int ident,double *poslo,double *poshi,int sort);
 int addsurfmol(simptr sim,int nmol,int ident,enum MolecState ms,double *pos,panelptr pnl,int surface,enum PanelShape ps,char *pname);
 int addcompartmol(simptr sim,int nmol,int ident,compartptr cmpt);
@@ -120,7 +132,11 @@ int molmovemol(simptr sim,moleculeptr mptr,const double *delta);
 // core simulation functions
 void moldosurfdrift2D(simptr sim,moleculeptr mptr,double dt);
 int molsort(simptr sim,int onlydead2live);
+int molreorder(simptr sim);
 int diffuse(simptr sim);
+int diffuse1D(simptr sim);
+int diffuse2D(simptr sim);
+int diffuse3D(simptr sim);
 
 /*********************************** Walls **********************************/
 
@@ -148,6 +164,9 @@ int wallsettype(simptr sim,int d,int highside,char type);
 // core simulation functions
 int checkwalls1mol(simptr sim,moleculeptr mptr);
 int checkwalls(simptr sim,int ll,int reborn,boxptr bptr);
+int checkwalls1D(simptr sim,int ll,int reborn,boxptr bptr);
+int checkwalls2D(simptr sim,int ll,int reborn,boxptr bptr);
+int checkwalls3D(simptr sim,int ll,int reborn,boxptr bptr);
 
 /********************************* Reactions ********************************/
 
@@ -200,6 +219,9 @@ int doreact(simptr sim,rxnptr rxn,moleculeptr mptr1,moleculeptr mptr2,int ll1,in
 int zeroreact(simptr sim);
 int unireact(simptr sim);
 int bireact(simptr sim,int neigh);
+int bireact1D(simptr sim,int neigh);
+int bireact2D(simptr sim,int neigh);
+int bireact3D(simptr sim,int neigh);
 
 /********************************** Rules ***********************************/
 
@@ -256,6 +278,7 @@ void surfsetcondition(surfacessptr surfss,enum StructCond cond,int upgrade);
 int surfsetepsilon(simptr sim,double epsilon);
 int surfsetmargin(simptr sim,double margin);
 int surfsetneighdist(simptr sim,double neighdist);
+int surfsetlocaldiffuse(simptr sim,int local);
 int surfsetcolor(surfaceptr srf,enum PanelFace face,double *rgba);
 int surfsetedgepts(surfaceptr srf,double value);
 int surfsetstipple(surfaceptr srf,int factor,int pattern);
@@ -288,6 +311,7 @@ int fixpt2panelnocross(simptr sim,double *pt,panelptr pnl,int dim,enum PanelFace
 int closestpanelpt(panelptr pnl,int dim,double *testpt,double *pnlpt,double neighdist);
 double closestsurfacept(surfaceptr srf,int dim,double *testpt,double *pnlpt,panelptr *pnlptr,boxptr bptr);
 void movemol2closepanel(simptr sim,moleculeptr mptr);
+void movemolonpanels(simptr sim,moleculeptr mptr,double dx,double dy);
 int checksurfaces1mol(simptr sim,moleculeptr mptr,double crossminimum);
 int checksurfaces(simptr sim,int ll,int reborn);
 int checksurfacebound(simptr sim,int ll);
@@ -295,7 +319,10 @@ int checksurfacebound(simptr sim,int ll);
 /*********************************** Boxes **********************************/
 
 // low level utilities
+void box2pos(simptr sim,boxptr bptr,double *poslo,double *poshi);
 boxptr pos2box(simptr sim,const double *pos);
+boxptr addr2box(boxssptr boxs,int b,int create);
+double boxvolume(simptr sim,boxptr bptr);
 void boxrandpos(simptr sim,double *pos,boxptr bptr);
 int boxaddmol(moleculeptr mptr,int ll);
 void boxremovemol(moleculeptr mptr,int ll);
@@ -313,11 +340,19 @@ int checkboxparams(simptr sim,int *warnptr);
 // structure set up
 void boxsetcondition(boxssptr boxs,enum StructCond cond,int upgrade);
 int boxsetsize(simptr sim,const char *info,double val);
+int boxsetautotune(simptr sim,int steps,double thresh);
+int boxsetcellstore(simptr sim,int cellstore);
+int boxsetadapt(simptr sim,int adapt);
+int boxsetsparse(simptr sim,int sparse);
 int boxesupdate(simptr sim);
 
 // core simulation functions
 boxptr line2nextbox(simptr sim,double *pt1,double *pt2,boxptr bptr);
 int reassignmolecs(simptr sim,int diffusing,int reborn);
+int reassignmolecs1D(simptr sim,int diffusing,int reborn);
+int reassignmolecs2D(simptr sim,int diffusing,int reborn);
+int reassignmolecs3D(simptr sim,int diffusing,int reborn);
+int boxesautotune(simptr sim,double cost);
 
 /******************************* Compartments *******************************/
 
@@ -521,6 +556,8 @@ void simsetcondition(simptr sim,enum StructCond cond,int upgrade);
 int simsetvariable(simptr sim,const char *name,double value);
 int simsetdim(simptr sim,int dim);
 int simsettime(simptr sim,double time,int code);
+int simsetthreads(simptr sim,int nthreads);
+void simsetfunctions(simptr sim);
 int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2);
 int loadsim(simptr sim,const char *fileroot,const char *filename,const char *flags);
 int simupdate(simptr sim);
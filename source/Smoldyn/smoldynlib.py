@@ -67,6 +67,10 @@ smolSetRandomSeed = smoldyn.smolSetRandomSeed
 smolSetRandomSeed.restype = c_int
 smolSetRandomSeed.argtypes = [c_void_p, c_long]
 
+smolSetThreads = smoldyn.smolSetThreads
+smolSetThreads.restype = c_int
+smolSetThreads.argtypes = [c_void_p, c_int]
+
 smolSetPartitions = smoldyn.smolSetPartitions
 smolSetPartitions.restype = c_int
 smolSetPartitions.argtypes = [c_void_p, c_char_p, c_double]
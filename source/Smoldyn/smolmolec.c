@@ -23,6 +23,15 @@
 #include "smoldynfuncs.h"
 #include "smoldynconfigure.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>
+	#define MOLSIMDX86
+#endif
+
+#define DIFBLOCK 256			// number of molecules diffused per block
+
+static int MolSimdLevel=-1;		// 0 for scalar, 1 for AVX2, 2 for AVX-512
+
 /******************************************************************************/
 /*********************************** Molecules ********************************/
 /******************************************************************************/
@@ -40,8 +49,12 @@ char *molmlt2string(enum MolListType mlt,char *string);
 char *molpos2string(simptr sim,moleculeptr mptr,char *string);
 
 // memory management
-moleculeptr molalloc(int dim);
-void molfree(moleculeptr mptr);
+void *molslaballoc(molssptr mols,size_t size);
+int molallocmols(molssptr mols,moleculeptr *mlist,int nmol,int dim,int coords);
+molstoreptr molstorealloc(int maxm,int dim);
+void molstorefree(molstoreptr store);
+int molstoreexpand(molstoreptr store,moleculeptr *mlist,int nmol,int maxm,int dim);
+void molstoreput(molssptr mols,moleculeptr mptr,int ll,int m);
 void molfreesurfdrift(double *****surfdrift,int maxspec,int maxsrf);
 molssptr molssalloc(molssptr mols,int maxspecies);
 int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt);
@@ -64,6 +77,12 @@ int molputimport(simptr sim,int nmol,int ident,enum MolecState ms,panelptr pnl,e
 int moldummyporter(simptr sim);
 
 // core simulation functions
+int molreorderlist(simptr sim,int ll);
+int molsimdlevel(void);
+void moldiffuseblock(double *pos,const double *step,const uint32_t *rnd,const double *gtable,uint32_t mask,int n);
+static inline int moldiffuserun(simptr sim,int ll,int m,int mmax,uint64_t *stream,const int dim);
+static inline void moldiffuse1mol(simptr sim,moleculeptr mptr,int copyposx,const int dim);
+static inline int diffusedim(simptr sim,const int dim);
 
 
 /******************************************************************************/
@@ -121,6 +140,40 @@ char *molmlt2string(enum MolListType mlt,char *string) {
 	return string; }
 
 
+/* molstring2order */
+enum MolOrder molstring2order(char *string) {
+	enum MolOrder ans;
+
+	if(!strcmp(string,"box")) ans=MObox;
+	else if(!strcmp(string,"morton")) ans=MOmorton;
+	else ans=MOnone;
+	return ans; }
+
+
+/* molorder2string */
+char *molorder2string(enum MolOrder order,char *string) {
+	if(order==MObox) strcpy(string,"box");
+	else if(order==MOmorton) strcpy(string,"morton");
+	else strcpy(string,"none");
+	return string; }
+
+
+/* molstring2gauss */
+enum MolGauss molstring2gauss(char *string) {
+	enum MolGauss ans;
+
+	if(!strcmp(string,"ziggurat")) ans=MGziggurat;
+	else ans=MGtable;
+	return ans; }
+
+
+/* molgauss2string */
+char *molgauss2string(enum MolGauss method,char *string) {
+	if(method==MGziggurat) strcpy(string,"ziggurat");
+	else strcpy(string,"table");
+	return string; }
+
+
 /******************************************************************************/
 /******************************** molecule patterns ***************************/
 /******************************************************************************/
@@ -805,6 +858,17 @@ failure:
 	return 1; }
 
 
+/* molsetgaussmethod */
+int molsetgaussmethod(simptr sim,enum MolGauss method) {
+	int er;
+
+	er=molenablemols(sim,-1);
+	if(er) return er;
+	if(method==MGziggurat) gaussziginit();
+	sim->mols->gaussmethod=method;
+	return 0; }
+
+
 /* molsetdifc */
 void molsetdifc(simptr sim,int ident,int *index,enum MolecState ms,double difc) {
 	int j;
@@ -1053,7 +1117,7 @@ void molsetexist(simptr sim,int ident,enum MolecState ms,int exist) {
 
 /* molcount */
 int molcount(simptr sim,int i,int *index,enum MolecState ms,int max) {
-	int count,ll,nmol,top,m,j,nresults,uselist;
+	int count,ll,nmol,top,m,j,nresults,uselist,ilo,ihi;
 	moleculeptr *mlist;
 	molssptr mols;
 	enum MolecState msval;
@@ -1064,83 +1128,19 @@ int molcount(simptr sim,int i,int *index,enum MolecState ms,int max) {
 	if(max<0) max=INT_MAX;
 	count=0;
 
-	if(i<0 && ms==MSall) {																	// all species, all states
-		for(ll=0;ll<mols->nlist;ll++)
-			count+=mols->sortl[ll];
-		count+=sim->mols->nd-sim->mols->topd;									// count resurrected molecules
-		for(ll=0;ll<mols->nlist;ll++) {												// count molecules that need sorting
-			mlist=mols->live[ll];
-			nmol=mols->nl[ll];
-			top=mols->sortl[ll];
-			for(m=top;m<nmol && count<max;m++)
-				if(mlist[m]->ident>0)
-					count++; }}
-
-	else if(i<0) {																					// all species, one state
-		for(ll=0;ll<mols->nlist;ll++) {
-			mlist=mols->live[ll];
-			top=mols->sortl[ll];
-			for(m=0;m<top && count<max;m++)										// count properly sorted molecules
-				if(mlist[m]->ident>0 && mlist[m]->mstate==ms)
-					count++; }
-		mlist=mols->dead;																			// count resurrected molecules
-		nmol=mols->nd;
-		top=mols->topd;
-		for(m=top;m<nmol && count<max;m++)
-			if(mlist[m]->ident>0 && mlist[m]->mstate==ms)
-				count++;
-		for(ll=0;ll<mols->nlist;ll++) {												// count molecules that need sorting
-			mlist=mols->live[ll];
-			nmol=mols->nl[ll];
-			top=mols->sortl[ll];
-			for(m=top;m<nmol && count<max;m++)
-				if(mlist[m]->ident>0 && mlist[m]->mstate==ms)
-					count++; }}
-
-	else if(i>0 && ms==MSall) {															// one species, all states
-		for(ll=0;ll<mols->nlist;ll++) {
-			uselist=0;
-			for(msval=(enum MolecState)0;msval<MSMAX && !uselist;msval=(enum MolecState)(msval+1))
-				if(mols->listlookup[i][msval]==ll) uselist=1;
-			if(uselist) {
-				mlist=mols->live[ll];
-				top=mols->sortl[ll];
-				for(m=0;m<top && count<max;m++)										// count properly sorted molecules
-					if(mlist[m]->ident==i)
-						count++; }}
-		mlist=mols->dead;																				// count resurrected molecules
-		nmol=mols->nd;
-		top=mols->topd;
-		for(m=top;m<nmol && count<max;m++)
-			if(mlist[m]->ident==i)
-				count++;
-		for(ll=0;ll<mols->nlist;ll++) {													// count molecules that need sorting
-			mlist=mols->live[ll];
-			nmol=mols->nl[ll];
-			top=mols->sortl[ll];
-			for(m=top;m<nmol && count<max;m++)
-				if(mlist[m]->ident==i)
-					count++; }}
-
-	else if(i>0) {																					// single species, single state
-		ll=mols->listlookup[i][ms];
-		mlist=mols->live[ll];
-		top=mols->sortl[ll];
-		for(m=0;m<top && count<max;m++)												// count properly sorted molecules
-			if(mlist[m]->ident==i && mlist[m]->mstate==ms) count++;
-		mlist=mols->dead;																			// count resurrected molecules
-		nmol=mols->nd;
-		top=mols->topd;
-		for(m=top;m<nmol && count<max;m++)
-			if(mlist[m]->ident==i && mlist[m]->mstate==ms) count++;
-		for(ll=0;ll<mols->nlist;ll++) {												// count molecules that need sorting
-			mlist=mols->live[ll];
-			nmol=mols->nl[ll];
-			top=mols->sortl[ll];
-			for(m=top;m<nmol && count<max;m++)
-				if(mlist[m]->ident==i && mlist[m]->mstate==ms) count++; }}
+	if(i!=0 || !index) {																		// one or all species, use population counts
+		if(ms!=MSall && ms>=MSMAX1) return 0;
+		if(i<0) {ilo=1;ihi=mols->nspecies;}
+		else {ilo=i;ihi=i+1;}
+		for(j=ilo;j<ihi;j++) {
+			if(ms==MSall)
+				for(msval=(enum MolecState)0;msval<MSMAX;msval=(enum MolecState)(msval+1))
+					count+=mols->count[j][msval];
+			else
+				count+=mols->count[j][ms]; }
+		return count<max?count:max; }
 
-	else if(index) {																				// list of molecules in index
+	else {																									// list of molecules in index
 		nresults=index[PDnresults];
 		for(ll=0;ll<mols->nlist;ll++) {
 			uselist=0;
@@ -1484,53 +1484,207 @@ double MolCalcDifcSum(simptr sim,int i1,enum MolecState ms1,int i2,enum MolecSta
 	return sum; }
 
 
+/* molpairstepmult */
+int molpairstepmult(simptr sim,int i1,enum MolecState ms1,int i2,enum MolecState ms2) {
+	molssptr mols;
+	int mult,ll;
+
+	mols=sim->mols;
+	mult=0;
+	if(!mols || !mols->stepmult) return 1;
+	if(i1) {
+		if(ms1>=MSMAX) ms1=MSsoln;
+		ll=mols->listlookup[i1][ms1];
+		if(ll>=0) mult=mols->stepmult[ll]; }
+	if(i2) {
+		if(ms2>=MSMAX) ms2=MSsoln;
+		ll=mols->listlookup[i2][ms2];
+		if(ll>=0 && (mult==0 || mols->stepmult[ll]<mult)) mult=mols->stepmult[ll]; }
+	return mult>0?mult:1; }
+
+
+/* mollistmoves */
+int mollistmoves(molssptr mols,int ll) {
+	return mols->stepmult[ll]==1 || mols->stepct%mols->stepmult[ll]==0; }
+
+
 /******************************************************************************/
 /****************************** memory management *****************************/
 /******************************************************************************/
 
-/* molalloc */
-moleculeptr molalloc(int dim) {
+/* molslaballoc */
+void *molslaballoc(molssptr mols,size_t size) {
+	void **newslab,*block;
+	int maxslab,k;
+
+	if(mols->nslab==mols->maxslab) {
+		maxslab=2*mols->maxslab+1;
+		newslab=(void**) calloc(maxslab,sizeof(void*));
+		if(!newslab) return NULL;
+		for(k=0;k<mols->nslab;k++) newslab[k]=mols->slab[k];
+		for(;k<maxslab;k++) newslab[k]=NULL;
+		free(mols->slab);
+		mols->slab=newslab;
+		mols->maxslab=maxslab; }
+
+	block=calloc(size+MOLSLABALIGN,1);
+	if(!block) return NULL;
+	mols->slab[mols->nslab++]=block;
+	return (void*)(((size_t)block+MOLSLABALIGN-1)&~(size_t)(MOLSLABALIGN-1)); }
+
+
+/* molallocmols */
+int molallocmols(molssptr mols,moleculeptr *mlist,int nmol,int dim,int coords) {
 	moleculeptr mptr;
-	int d;
+	double *vect;
+	int m,nvect;
+	size_t vectsize;
+
+	if(nmol<=0) return 0;
+	nvect=coords?4:2;
+	vectsize=(size_t)nmol*nvect*dim*sizeof(double);
+	vect=(double*) molslaballoc(mols,vectsize+(size_t)nmol*sizeof(struct moleculestruct));
+	if(!vect) {
+		simLog(NULL,10,"Unable to allocate memory in molallocmols");
+		return 1; }
+	mptr=(moleculeptr)((char*)vect+vectsize);
 
-	mptr=NULL;
-	CHECKMEM(mptr=(moleculeptr) malloc(sizeof(struct moleculestruct)));
-	mptr->serno=0;
-	mptr->list=-1;
-	mptr->pos=NULL;
-	mptr->posx=NULL;
-	mptr->via=NULL;
-	mptr->posoffset=NULL;
-	mptr->ident=0;
-	mptr->mstate=MSsoln;
-	mptr->box=NULL;
-	mptr->pnl=NULL;
-	mptr->pnlx=NULL;
+	for(m=0;m<nmol;m++) {
+		mptr->serno=0;
+		mptr->list=-1;
+		mptr->via=vect;
+		mptr->posoffset=vect+dim;
+		if(coords) {
+			mptr->pos=vect+2*dim;
+			mptr->posx=vect+3*dim; }
+		else {
+			mptr->pos=NULL;
+			mptr->posx=NULL; }
+		mptr->ident=0;
+		mptr->mstate=MSsoln;
+		mptr->box=NULL;
+		mptr->boxm=-1;
+		mptr->pnl=NULL;
+		mptr->pnlx=NULL;
+		mlist[m]=mptr;
+		mptr++;
+		vect+=nvect*dim; }
+	return 0; }
 
-	CHECKMEM(mptr->pos=(double*) calloc(dim,sizeof(double)));
-	CHECKMEM(mptr->posx=(double*) calloc(dim,sizeof(double)));
-	CHECKMEM(mptr->via=(double*) calloc(dim,sizeof(double)));
-	CHECKMEM(mptr->posoffset=(double*) calloc(dim,sizeof(double)));
-	for(d=0;d<dim;d++)
-		mptr->pos[d]=mptr->posx[d]=mptr->via[d]=mptr->posoffset[d]=0;
-	return mptr;
+
+/* molstorealloc */
+molstoreptr molstorealloc(int maxm,int dim) {
+	molstoreptr store;
+
+	store=NULL;
+	CHECKMEM(store=(molstoreptr) malloc(sizeof(struct molstorestruct)));
+	store->maxm=0;
+	store->pos=NULL;
+	store->posx=NULL;
+	if(maxm>0) {
+		CHECKMEM(store->pos=(double*) calloc(maxm*dim,sizeof(double)));
+		CHECKMEM(store->posx=(double*) calloc(maxm*dim,sizeof(double)));
+		store->maxm=maxm; }
+	return store;
  failure:
-	molfree(mptr);
-	simLog(NULL,10,"Unable to allocate memory in molalloc");
+	molstorefree(store);
+	simLog(NULL,10,"Unable to allocate memory in molstorealloc");
 	return NULL; }
 
 
-/* molfree */
-void molfree(moleculeptr mptr) {
-	if(!mptr) return;
-	if(mptr->pos) free(mptr->pos);
-	if(mptr->posx) free(mptr->posx);
-	if(mptr->posoffset) free(mptr->posoffset);
-	if(mptr->via) free(mptr->via);
-	free(mptr);
+/* molstorefree */
+void molstorefree(molstoreptr store) {
+	if(!store) return;
+	free(store->pos);
+	free(store->posx);
+	free(store);
 	return; }
 
 
+/* molstoreexpand */
+int molstoreexpand(molstoreptr store,moleculeptr *mlist,int nmol,int maxm,int dim) {
+	double *newpos,*newposx;
+	int m;
+
+	if(maxm<=store->maxm) return 0;
+	newpos=(double*) calloc(maxm*dim,sizeof(double));
+	newposx=(double*) calloc(maxm*dim,sizeof(double));
+	if(!newpos || !newposx) {
+		free(newpos);
+		free(newposx);
+		return 1; }
+	if(store->maxm) {
+		memcpy(newpos,store->pos,store->maxm*dim*sizeof(double));
+		memcpy(newposx,store->posx,store->maxm*dim*sizeof(double)); }
+	for(m=0;m<nmol;m++)
+		if(mlist[m]) {
+			mlist[m]->pos=newpos+m*dim;
+			mlist[m]->posx=newposx+m*dim; }
+	free(store->pos);
+	free(store->posx);
+	store->pos=newpos;
+	store->posx=newposx;
+	store->maxm=maxm;
+	return 0; }
+
+
+/* molstoreput */
+void molstoreput(molssptr mols,moleculeptr mptr,int ll,int m) {
+	molstoreptr store;
+	double *pos,*posx;
+	int d,dim;
+
+	if(!mols->molstore || !mptr) return;
+	dim=mols->sim->dim;
+	store=ll<0?mols->deadstore:mols->livestore[ll];
+	pos=store->pos+m*dim;
+	posx=store->posx+m*dim;
+	if(mptr->pos==pos) return;
+	if(mptr->pos)
+		for(d=0;d<dim;d++) {
+			pos[d]=mptr->pos[d];
+			posx[d]=mptr->posx[d]; }
+	else
+		for(d=0;d<dim;d++) pos[d]=posx[d]=0;
+	mptr->pos=pos;
+	mptr->posx=posx;
+	return; }
+
+
+/* molstoresync */
+int molstoresync(molssptr mols,int ll) {
+	molstoreptr store;
+	moleculeptr *mlist,mptr;
+	double *newpos,*newposx;
+	int m,d,dim,nmol;
+
+	if(!mols || !mols->molstore) return 0;
+	dim=mols->sim->dim;
+	store=ll<0?mols->deadstore:mols->livestore[ll];
+	mlist=ll<0?mols->dead:mols->live[ll];
+	nmol=ll<0?mols->nd:mols->nl[ll];
+	if(store->maxm==0) return 0;
+
+	newpos=(double*) calloc(store->maxm*dim,sizeof(double));
+	newposx=(double*) calloc(store->maxm*dim,sizeof(double));
+	if(!newpos || !newposx) {
+		free(newpos);
+		free(newposx);
+		return 1; }
+	for(m=0;m<nmol;m++) {
+		mptr=mlist[m];
+		for(d=0;d<dim;d++) {
+			newpos[m*dim+d]=mptr->pos[d];
+			newposx[m*dim+d]=mptr->posx[d]; }
+		mptr->pos=newpos+m*dim;
+		mptr->posx=newposx+m*dim; }
+	free(store->pos);
+	free(store->posx);
+	store->pos=newpos;
+	store->posx=newposx;
+	return 0; }
+
+
 /* molexpandsurfdrift */
 int molexpandsurfdrift(simptr sim,int oldmaxspec,int oldmaxsrf) {	//?? needs to be called whenever maxspecies or maxsrf increase
 	double *****oldsurfdrift;
@@ -1640,10 +1794,10 @@ int molpatternalloc(simptr sim,int maxpattern) {
 
 /* molssalloc */
 molssptr molssalloc(molssptr mols,int maxspecies) {
-	int i,**newexist,**newlistlookup,*newexpand,oldmaxspecies;
+	int i,**newexist,**newcount,**newmobile,**newlistlookup,*newexpand,oldmaxspecies;
 	enum MolecState ms;
 	char **newspname;
-	double **newdifc,**newdifstep,***newdifm,***newdrift,**newdisplay,***newcolor;
+	double **newdifc,**newdifstep,***newdifm,***newdifmstep,***newdrift,**newdisplay,***newcolor;
 
 	if(maxspecies<1) return NULL;
 	maxspecies++;
@@ -1666,11 +1820,14 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 		mols->difc=NULL;
 		mols->difstep=NULL;
 		mols->difm=NULL;
+		mols->difmstep=NULL;
 		mols->drift=NULL;
 		mols->surfdrift=NULL;
 		mols->display=NULL;
 		mols->color=NULL;
 		mols->exist=NULL;
+		mols->count=NULL;
+		mols->mobile=NULL;
 		mols->dead=NULL;
 		mols->maxdlimit=-1;
 		mols->maxd=0;
@@ -1687,11 +1844,23 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 		mols->topl=NULL;
 		mols->sortl=NULL;
 		mols->diffuselist=NULL;
+		mols->stepmult=NULL;
+		mols->stepct=0;
 		mols->serno=1;
 		mols->ngausstbl=0;
 		mols->gausstbl=NULL;
+		mols->gaussmethod=MGtable;
 		mols->expand=NULL;
-		mols->touch=0; }
+		mols->touch=0;
+		mols->molstore=0;
+		mols->deadstore=NULL;
+		mols->livestore=NULL;
+		mols->order=MOnone;
+		mols->orderinterval=0;
+		mols->orderct=0;
+		mols->maxslab=0;
+		mols->nslab=0;
+		mols->slab=NULL; }
 
 	if(maxspecies>mols->maxspecies) {
 		oldmaxspecies=mols->maxspecies;
@@ -1725,6 +1894,13 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 			CHECKMEM(newdifm[i]=(double**) calloc(MSMAX,sizeof(double*)));
 			for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1)) newdifm[i][ms]=NULL; }
 
+		CHECKMEM(newdifmstep=(double***) calloc(maxspecies,sizeof(double**)));
+		for(i=0;i<maxspecies;i++) newdifmstep[i]=NULL;
+		for(i=0;i<oldmaxspecies;i++) newdifmstep[i]=mols->difmstep[i];
+		for(;i<maxspecies;i++) {
+			CHECKMEM(newdifmstep[i]=(double**) calloc(MSMAX,sizeof(double*)));
+			for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1)) newdifmstep[i][ms]=NULL; }
+
 		CHECKMEM(newdrift=(double***) calloc(maxspecies,sizeof(double**)));
 		for(i=0;i<maxspecies;i++) newdrift[i]=NULL;
 		for(i=0;i<oldmaxspecies;i++) newdrift[i]=mols->drift[i];
@@ -1756,6 +1932,20 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 			CHECKMEM(newexist[i]=(int*) calloc(MSMAX,sizeof(int)));
 			for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1)) newexist[i][ms]=0; }
 
+		CHECKMEM(newcount=(int**) calloc(maxspecies,sizeof(int*)));
+		for(i=0;i<maxspecies;i++) newcount[i]=NULL;
+		for(i=0;i<oldmaxspecies;i++) newcount[i]=mols->count[i];
+		for(;i<maxspecies;i++) {
+			CHECKMEM(newcount[i]=(int*) calloc(MSMAX1,sizeof(int)));
+			for(ms=(enum MolecState)(0);ms<MSMAX1;ms=(enum MolecState)(ms+1)) newcount[i][ms]=0; }
+
+		CHECKMEM(newmobile=(int**) calloc(maxspecies,sizeof(int*)));
+		for(i=0;i<maxspecies;i++) newmobile[i]=NULL;
+		for(i=0;i<oldmaxspecies;i++) newmobile[i]=mols->mobile[i];
+		for(;i<maxspecies;i++) {
+			CHECKMEM(newmobile[i]=(int*) calloc(MSMAX,sizeof(int)));
+			for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1)) newmobile[i][ms]=1; }
+
 		CHECKMEM(newlistlookup=(int**) calloc(maxspecies,sizeof(int*)));
 		for(i=0;i<maxspecies;i++) newlistlookup[i]=NULL;
 		for(i=0;i<oldmaxspecies;i++) newlistlookup[i]=mols->listlookup[i];
@@ -1776,6 +1966,8 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 		mols->difstep=newdifstep;
 		free(mols->difm);
 		mols->difm=newdifm;
+		free(mols->difmstep);
+		mols->difmstep=newdifmstep;
 		free(mols->drift);
 		mols->drift=newdrift;
 		free(mols->display);
@@ -1784,6 +1976,10 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 		mols->color=newcolor;
 		free(mols->exist);
 		mols->exist=newexist;
+		free(mols->count);
+		mols->count=newcount;
+		free(mols->mobile);
+		mols->mobile=newmobile;
 		free(mols->listlookup);
 		mols->listlookup=newlistlookup;
 		free(mols->expand);
@@ -1801,10 +1997,11 @@ molssptr molssalloc(molssptr mols,int maxspecies) {
 
 /* mollistalloc */
 int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
-	int *maxl,*nl,*topl,*sortl,*diffuselist,ll,m;
+	int *maxl,*nl,*topl,*sortl,*diffuselist,*stepmult,ll,m;
 	moleculeptr **live,mptr;
 	char **listname;
 	enum MolListType *listtype;
+	molstoreptr *livestore;
 
 	if(maxlist<=0) return -2;
 	if(!mols) return -3;
@@ -1818,6 +2015,8 @@ int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
 	topl=NULL;
 	sortl=NULL;
 	diffuselist=NULL;
+	stepmult=NULL;
+	livestore=NULL;
 
 	CHECKMEM(listname=(char**) calloc(maxlist,sizeof(char*)));
 	for(ll=0;ll<maxlist;ll++) listname[ll]=NULL;
@@ -1843,6 +2042,9 @@ int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
 	CHECKMEM(diffuselist=(int*) calloc(maxlist,sizeof(int)));
 	for(ll=0;ll<maxlist;ll++) diffuselist[ll]=0;
 
+	CHECKMEM(stepmult=(int*) calloc(maxlist,sizeof(int)));
+	for(ll=0;ll<maxlist;ll++) stepmult[ll]=1;
+
 	for(ll=0;ll<mols->maxlist;ll++) {			// copy over existing portions
 		listname[ll]=mols->listname[ll];
 		listtype[ll]=mols->listtype[ll];
@@ -1851,7 +2053,8 @@ int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
 		nl[ll]=mols->nl[ll];
 		topl[ll]=mols->topl[ll];
 		sortl[ll]=mols->sortl[ll];
-		diffuselist[ll]=mols->diffuselist[ll]; }
+		diffuselist[ll]=mols->diffuselist[ll];
+		stepmult[ll]=mols->stepmult[ll]; }
 
 	for(ll=mols->maxlist;ll<maxlist;ll++) {					// listnames and listtypes
 		CHECKMEM(listname[ll]=EmptyString());
@@ -1869,6 +2072,14 @@ int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
 		CHECKMEM(live[ll]=(moleculeptr*) calloc(maxl[ll],sizeof(moleculeptr)));
 		for(m=0;m<maxl[ll];m++) live[ll][m]=NULL; }
 
+	if(mols->molstore) {										// allocate coordinate stores
+		CHECKMEM(livestore=(molstoreptr*) calloc(maxlist,sizeof(molstoreptr)));
+		for(ll=0;ll<maxlist;ll++) livestore[ll]=NULL;
+		for(ll=mols->maxlist;ll<maxlist;ll++)
+			CHECKMEM(livestore[ll]=molstorealloc(maxl[ll],mols->sim->dim));
+		for(ll=0;ll<mols->maxlist;ll++)
+			livestore[ll]=mols->livestore[ll]; }
+
 	if(mols->maxlist) {										// free any old lists
 		free(mols->listname);
 		free(mols->listtype);
@@ -1877,7 +2088,9 @@ int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
 		free(mols->nl);
 		free(mols->topl);
 		free(mols->sortl);
-		free(mols->diffuselist); }
+		free(mols->diffuselist);
+		free(mols->stepmult);
+		free(mols->livestore); }
 	ll=mols->maxlist;
 	mols->maxlist=maxlist;									// store new lists
 	mols->listname=listname;
@@ -1888,6 +2101,8 @@ int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
 	mols->topl=topl;
 	mols->sortl=sortl;
 	mols->diffuselist=diffuselist;
+	mols->stepmult=stepmult;
+	mols->livestore=livestore;
 	return ll;
 
  failure:
@@ -1903,6 +2118,10 @@ int mollistalloc(molssptr mols,int maxlist,enum MolListType mlt) {
 	free(topl);
 	free(sortl);
 	free(diffuselist);
+	free(stepmult);
+	if(livestore)
+		for(ll=mols->maxlist;ll<maxlist;ll++) molstorefree(livestore[ll]);
+	free(livestore);
 	simLog(NULL,10,"Unable to allocate memory in mollistalloc");
 	return -1; }
 
@@ -1922,6 +2141,7 @@ int molexpandlist(molssptr mols,int dim,int ll,int nspaces,int nmolecs) {
 	maxnew=nspaces>0?maxold+nspaces:2*maxold+1;		// maxnew is new allocated size
 	if(nold+nmolecs>maxnew) return 3;
 
+	CHECKMEM(!mols->molstore || !molstoreexpand(ll<0?mols->deadstore:mols->livestore[ll],oldlist,nold,maxnew,dim));
 	newlist=(moleculeptr*) calloc(maxnew,sizeof(moleculeptr));
 	CHECKMEM(newlist);
 	for(m=0;m<maxold;m++) newlist[m]=oldlist[m];
@@ -1938,10 +2158,11 @@ int molexpandlist(molssptr mols,int dim,int ll,int nspaces,int nmolecs) {
 	if(nmolecs) {
 		for(m=mols->nd-1;m>=mols->topd;m--) {					// copy resurrected molecules higher on list
 			newlist[m+nmolecs]=newlist[m];
+			molstoreput(mols,newlist[m+nmolecs],-1,m+nmolecs);
 			newlist[m]=NULL; }
-		for(m=mols->topd;m<mols->topd+nmolecs;m++) {		// create new empty molecules
-			newlist[m]=molalloc(dim);
-			if(!newlist[m]) return 4; }
+		if(molallocmols(mols,newlist+mols->topd,nmolecs,dim,!mols->molstore)) return 4;	// create new empty molecules
+		for(m=mols->topd;m<mols->topd+nmolecs;m++)
+			molstoreput(mols,newlist[m],-1,m);
 		mols->topd+=nmolecs;
 		mols->nd+=nmolecs; }
 	return 0;
@@ -1952,7 +2173,7 @@ failure:
 
 /* molssfree */
 void molssfree(molssptr mols,int maxsrf) {
-	int m,ll,i,maxspecies;
+	int ll,i,k,maxspecies;
 	enum MolecState ms;
 
 	if(!mols) return;
@@ -1964,10 +2185,11 @@ void molssfree(molssptr mols,int maxsrf) {
 
 	for(ll=0;ll<mols->maxlist;ll++) {
 		if(mols->listname) free(mols->listname[ll]);
-		if(mols->live && mols->live[ll]) {
-			for(m=0;m<mols->nl[ll];m++) molfree(mols->live[ll][m]);
-			free(mols->live[ll]); }}
+		if(mols->live) free(mols->live[ll]);
+		if(mols->livestore) molstorefree(mols->livestore[ll]); }
+	free(mols->livestore);
 	free(mols->diffuselist);
+	free(mols->stepmult);
 	free(mols->sortl);
 	free(mols->topl);
 	free(mols->nl);
@@ -1984,9 +2206,19 @@ void molssfree(molssptr mols,int maxsrf) {
 		for(i=0;i<maxspecies;i++) free(mols->exist[i]);
 		free(mols->exist); }
 
-	if(mols->dead) {
-		for(m=0;m<mols->nd;m++) molfree(mols->dead[m]);
-		free(mols->dead); }
+	if(mols->count) {
+		for(i=0;i<maxspecies;i++) free(mols->count[i]);
+		free(mols->count); }
+
+	if(mols->mobile) {
+		for(i=0;i<maxspecies;i++) free(mols->mobile[i]);
+		free(mols->mobile); }
+
+	free(mols->dead);
+	molstorefree(mols->deadstore);
+
+	for(k=0;k<mols->nslab;k++) free(mols->slab[k]);
+	free(mols->slab);
 
 	if(mols->color) {
 		for(i=0;i<maxspecies;i++)
@@ -2015,6 +2247,13 @@ void molssfree(molssptr mols,int maxsrf) {
 				free(mols->difm[i]); }
 		free(mols->difm); }
 
+	if(mols->difmstep) {
+		for(i=0;i<maxspecies;i++)
+			if(mols->difmstep[i]) {
+				for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1)) free(mols->difmstep[i][ms]);
+				free(mols->difmstep[i]); }
+		free(mols->difmstep); }
+
 	if(mols->difstep) {
 		for(i=0;i<maxspecies;i++) free(mols->difstep[i]);
 		free(mols->difstep); }
@@ -2070,6 +2309,9 @@ void molssoutput(simptr sim) {
 	simLog(sim,1," Next molecule serial number: %lu\n",mols->serno);
 	if(mols->gausstbl) simLog(sim,1," Table for Gaussian distributed random numbers has %i values\n",mols->ngausstbl);
 	else simLog(sim,1," Table for Gaussian distributed random numbers has not been set up\n");
+	if(mols->gaussmethod==MGziggurat) simLog(sim,2," Diffusion uses Gaussian random numbers from the Ziggurat method\n");
+	if(mols->molstore) simLog(sim,1," Molecule coordinates are stored contiguously for each list\n");
+	if(mols->order!=MOnone) simLog(sim,2," Live lists are reordered by %s every %i time steps\n",molorder2string(mols->order,string),mols->orderinterval);
 
 	simLog(sim,2," %i molecule lists:\n",mols->nlist);
 	for(ll=0;ll<mols->nlist;ll++) {
@@ -2086,6 +2328,8 @@ void molssoutput(simptr sim) {
 	for(ll=0;ll<mols->nlist;ll++)
 		if(mols->diffuselist[ll]) simLog(sim,1," %s",mols->listname[ll]);
 	simLog(sim,1,"\n");
+	for(ll=0;ll<mols->nlist;ll++)
+		if(mols->stepmult[ll]>1) simLog(sim,2," List %s diffuses every %i time steps\n",mols->listname[ll],mols->stepmult[ll]);
 
 	if(mols->npattern>0) {
 		simLog(sim,1," Species groups:\n");
@@ -2204,11 +2448,18 @@ void writemols(simptr sim,FILE *fptr) {
 	fprintf(fptr,"\n");
 	if(sim->mols->maxdlimit>=0)
 		fprintf(fptr,"max_mol %i\n",sim->mols->maxdlimit);
-	fprintf(fptr,"gauss_table_size %i\n\n",mols->ngausstbl);
+	fprintf(fptr,"gauss_table_size %i\n",mols->ngausstbl);
+	if(mols->gaussmethod!=MGtable) fprintf(fptr,"rand_gaussian %s\n",molgauss2string(mols->gaussmethod,string));
+	if(mols->molstore) fprintf(fptr,"molecule_store contiguous\n");
+	if(mols->order!=MOnone) fprintf(fptr,"molecule_order %s %i\n",molorder2string(mols->order,string),mols->orderinterval);
+	fprintf(fptr,"\n");
 
 	for(ll=0;ll<mols->nlist;ll++)
 		if(mols->listtype[ll]==MLTsystem)
 			fprintf(fptr,"molecule_lists %s\n",mols->listname[ll]);
+	for(ll=0;ll<mols->nlist;ll++)
+		if(mols->listtype[ll]==MLTsystem && mols->stepmult[ll]>1)
+			fprintf(fptr,"mol_list_step %s %i\n",mols->listname[ll],mols->stepmult[ll]);
 	fprintf(fptr,"\n");
 
 	for(i=1;i<mols->nspecies;i++) {
@@ -2465,6 +2716,97 @@ int molsetmaxmol(simptr sim,int max) {
 	return 0; }
 
 
+/* molsetstore */
+int molsetstore(simptr sim,int store) {
+	molssptr mols;
+	int er,ll,m,n,nmol,dim;
+	moleculeptr mptr,*mlist;
+	double *vect;
+
+	if(!sim->mols) {
+		er=molenablemols(sim,-1);
+		if(er) return er; }
+	mols=sim->mols;
+	store=store?1:0;
+	if(store==mols->molstore) return 0;
+	dim=sim->dim;
+	if(dim<1) return 2;
+
+	if(store) {																		// separate -> contiguous
+		CHECKMEM(mols->deadstore=molstorealloc(mols->maxd,dim));
+		if(mols->maxlist) {
+			CHECKMEM(mols->livestore=(molstoreptr*) calloc(mols->maxlist,sizeof(molstoreptr)));
+			for(ll=0;ll<mols->maxlist;ll++) mols->livestore[ll]=NULL;
+			for(ll=0;ll<mols->maxlist;ll++)
+				CHECKMEM(mols->livestore[ll]=molstorealloc(mols->maxl[ll],dim)); }
+		mols->molstore=1;
+		for(ll=-1;ll<mols->nlist;ll++) {
+			mlist=ll<0?mols->dead:mols->live[ll];
+			n=ll<0?mols->nd:mols->nl[ll];
+			for(m=0;m<n;m++)
+				molstoreput(mols,mlist[m],ll,m); }}
+	else {																				// contiguous -> separate
+		nmol=mols->nd;
+		for(ll=0;ll<mols->nlist;ll++) nmol+=mols->nl[ll];
+		if(nmol>0) {
+			vect=(double*) molslaballoc(mols,(size_t)nmol*2*dim*sizeof(double));
+			if(!vect) {
+				simLog(sim,10,"Unable to allocate memory in molsetstore");
+				return 1; }
+			for(ll=-1;ll<mols->nlist;ll++) {
+				mlist=ll<0?mols->dead:mols->live[ll];
+				n=ll<0?mols->nd:mols->nl[ll];
+				for(m=0;m<n;m++) {
+					mptr=mlist[m];
+					copyVD(mptr->pos,vect,dim);
+					copyVD(mptr->posx,vect+dim,dim);
+					mptr->pos=vect;
+					mptr->posx=vect+dim;
+					vect+=2*dim; }}}
+		for(ll=0;ll<mols->maxlist;ll++) molstorefree(mols->livestore[ll]);
+		free(mols->livestore);
+		mols->livestore=NULL;
+		molstorefree(mols->deadstore);
+		mols->deadstore=NULL;
+		mols->molstore=0; }
+	return 0;
+
+ failure:
+	if(mols->livestore)
+		for(ll=0;ll<mols->maxlist;ll++) molstorefree(mols->livestore[ll]);
+	free(mols->livestore);
+	mols->livestore=NULL;
+	molstorefree(mols->deadstore);
+	mols->deadstore=NULL;
+	simLog(sim,10,"Unable to allocate memory in molsetstore");
+	return 1; }
+
+
+/* molsetorder */
+int molsetorder(simptr sim,enum MolOrder order,int interval) {
+	int er;
+
+	if(!sim->mols) {
+		er=molenablemols(sim,-1);
+		if(er) return er; }
+	if(order!=MOnone && interval<1) return 2;
+	sim->mols->order=order;
+	sim->mols->orderinterval=(order==MOnone)?0:interval;
+	sim->mols->orderct=0;
+	return 0; }
+
+
+/* molsetliststep */
+int molsetliststep(simptr sim,int ll,int mult) {
+	if(!sim->mols || ll<0 || ll>=sim->mols->nlist) return 3;
+	if(mult<1) return 2;
+	sim->mols->stepmult[ll]=mult;
+	molsetcondition(sim->mols,SCparams,0);
+	rxnsetcondition(sim,-1,SCparams,0);
+	surfsetcondition(sim->srfss,SCparams,0);
+	return 0; }
+
+
 /* moladdspecies */
 int moladdspecies(simptr sim,const char *nm) {
 	molssptr mols;
@@ -2566,18 +2908,41 @@ int molgeneratespecies(simptr sim,const char *name,int nparents,int parent1,int
 
 /* molsupdateparams */
 int molsupdateparams(molssptr mols,double dt) {
-	int i,ll;
+	int i,ll,d,dim;
 	enum MolecState ms;
+	double scale;
 
-	for(ll=0;ll<mols->nlist;ll++) mols->diffuselist[ll]=0;		// set diffuselist
+	for(ll=0;ll<mols->nlist;ll++) mols->diffuselist[ll]=0;		// set mobile and diffuselist
 	for(i=0;i<mols->nspecies;i++)
 		for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1)) {
-			if(molismobile(mols->sim,i,ms))
+			mols->mobile[i][ms]=molismobile(mols->sim,i,ms);
+			if(mols->mobile[i][ms])
 				mols->diffuselist[mols->listlookup[i][ms]]=1; }
+	for(i=1;i<mols->nspecies;i++)
+		for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1)) {
+			ll=mols->listlookup[i][ms];
+			if(ll>=0 && !mols->mobile[i][ms] && mols->diffuselist[ll])
+				mols->diffuselist[ll]=2; }
 
-	for(i=0;i<mols->nspecies;i++)					// calculate difstep
-		for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1))
-			mols->difstep[i][ms]=sqrt(2.0*mols->difc[i][ms]*dt);
+	for(i=0;i<mols->nspecies;i++)					// calculate difstep, for the list's time step
+		for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1)) {
+			ll=mols->listlookup[i][ms];
+			mols->difstep[i][ms]=sqrt(2.0*mols->difc[i][ms]*dt*(ll>=0?mols->stepmult[ll]:1)); }
+
+	dim=mols->sim->dim;
+	for(i=0;i<mols->nspecies;i++)					// calculate difmstep, the scaled diffusion matrix
+		for(ms=(enum MolecState)(0);ms<MSMAX;ms=(enum MolecState)(ms+1)) {
+			if(!mols->difm[i][ms]) {
+				free(mols->difmstep[i][ms]);
+				mols->difmstep[i][ms]=NULL; }
+			else {
+				if(!mols->difmstep[i][ms]) {
+					mols->difmstep[i][ms]=(double*) calloc(dim*dim,sizeof(double));
+					if(!mols->difmstep[i][ms]) return 1; }
+				ll=mols->listlookup[i][ms];
+				scale=sqrt(2.0*dt*(ll>=0?mols->stepmult[ll]:1));
+				for(d=0;d<dim*dim;d++)
+					mols->difmstep[i][ms][d]=mols->difm[i][ms][d]*scale; }}
 
 	return 0; }
 
@@ -2676,6 +3041,7 @@ int molsupdate(simptr sim) {
 void molkill(simptr sim,moleculeptr mptr,int ll,int m) {
 	int d;
 
+	if(mptr->ident>0) sim->mols->count[mptr->ident][mptr->mstate]--;
 	mptr->ident=0;
 	mptr->mstate=MSsoln;
 	mptr->list=-1;
@@ -2708,6 +3074,12 @@ moleculeptr getnextmol(molssptr mols) {
 	return mptr; }
 
 
+/* molcountadd */
+void molcountadd(molssptr mols,moleculeptr mptr) {
+	if(mptr->ident>0) mols->count[mptr->ident][mptr->mstate]++;
+	return; }
+
+
 /* newestmol */
 moleculeptr newestmol(molssptr mols) {
 	return mols->dead[mols->topd-1]; }
@@ -2730,9 +3102,10 @@ int addmol(simptr sim,int nmol,int ident,double *poslo,double *poshi,int sort) {
 		else
 			for(d=0;d<sim->dim;d++)
 				mptr->posx[d]=mptr->pos[d]=unirandOOD(poslo[d],poshi[d]);
-		if(sim->boxs && sim->boxs->nbox)
+		if(sim->boxs && sim->boxs->ngrid)
 			mptr->box=pos2box(sim,mptr->pos);
-		else mptr->box=NULL; }
+		else mptr->box=NULL;
+		molcountadd(sim->mols,mptr); }
 	molsetexist(sim,ident,MSsoln,1);
 	sim->mols->expand[ident]|=1;
 	if(sort)
@@ -2775,8 +3148,9 @@ int addsurfmol(simptr sim,int nmol,int ident,enum MolecState ms,double *pos,pane
 			else if(ms==MSback) fixpt2panel(mpos,pnl,dim,PFback,0);
 			else fixpt2panel(mpos,pnl,dim,PFnone,0);
 			for(d=0;d<dim;d++) mptr->pos[d]=mptr->posx[d]=mpos[d];
-			if(sim->boxs && sim->boxs->nbox) mptr->box=pos2box(sim,mpos);
-			else mptr->box=NULL; }}
+			if(sim->boxs && sim->boxs->ngrid) mptr->box=pos2box(sim,mpos);
+			else mptr->box=NULL;
+			molcountadd(sim->mols,mptr); }}
 
 	else {																						// create area lookup tables
 		surfacearea2(sim,surface,ps,pname,&totpanel);
@@ -2818,8 +3192,9 @@ int addsurfmol(simptr sim,int nmol,int ident,enum MolecState ms,double *pos,pane
 			if(ms==MSfront) fixpt2panel(mpos,pnl,dim,PFfront,0);
 			else if(ms==MSback) fixpt2panel(mpos,pnl,dim,PFback,0);
 			for(d=0;d<dim;d++) mptr->pos[d]=mptr->posx[d]=mpos[d];
-			if(sim->boxs && sim->boxs->nbox) mptr->box=pos2box(sim,mpos);
-			else mptr->box=NULL; }
+			if(sim->boxs && sim->boxs->ngrid) mptr->box=pos2box(sim,mpos);
+			else mptr->box=NULL;
+			molcountadd(sim->mols,mptr); }
 
 		free(paneltable);
 		free(areatable); }
@@ -2846,8 +3221,9 @@ int addcompartmol(simptr sim,int nmol,int ident,compartptr cmpt) {
 		er=compartrandpos(sim,mptr->pos,cmpt);
 		if(er) return 2;
 		for(d=0;d<dim;d++) mptr->posx[d]=mptr->pos[d];
-		if(sim->boxs && sim->boxs->nbox) mptr->box=pos2box(sim,mptr->pos);
-		else mptr->box=NULL; }
+		if(sim->boxs && sim->boxs->ngrid) mptr->box=pos2box(sim,mptr->pos);
+		else mptr->box=NULL;
+		molcountadd(sim->mols,mptr); }
 	molsetexist(sim,ident,MSsoln,1);
 	sim->mols->expand[ident]|=1;
 	return 0; }
@@ -2873,6 +3249,7 @@ void molchangeident(simptr sim,moleculeptr mptr,int ll,int m,int i,enum MolecSta
 	epsilon=sim->srfss?sim->srfss->epsilon:0;
 	oldi=mptr->ident;
 	oldms=mptr->mstate;
+	if(oldi>0) sim->mols->count[oldi][oldms]--;
 
 	mptr->ident=i;
 	mptr->mstate=ms;
@@ -2898,6 +3275,7 @@ void molchangeident(simptr sim,moleculeptr mptr,int ll,int m,int i,enum MolecSta
 		fixpt2panel(mptr->pos,pnl,dim,PFback,epsilon);
 	else																					// any -> up or down
 		fixpt2panel(mptr->pos,pnl,dim,PFnone,epsilon);
+	sim->mols->count[i][mptr->mstate]++;
 
 	ll2=sim->mols->listlookup[i][ms];
 	if(ll>=0 && ll2!=ll) {
@@ -2971,7 +3349,9 @@ int molsort(simptr sim,int onlydead2live) {
           if(mptr->list==-1) {						// move to dead list
             if(mptr->box) boxremovemol(mptr,ll);
 						if(mptr->pnl) surfremovemol(mptr,ll);
+						if(mols->topd<mols->nd) molstoreput(mols,dead[mols->topd],-1,mols->nd);
             dead[mols->nd++]=dead[mols->topd];
+						molstoreput(mols,mptr,-1,mols->topd);
             dead[mols->topd++]=mptr;
             mlist[m]=NULL; }
           else {													// move to another live list
@@ -2983,6 +3363,7 @@ int molsort(simptr sim,int onlydead2live) {
             if(nl[ll2]==maxl[ll2])
               if(molexpandlist(mols,sim->dim,ll2,-1,0)) {
                 simLog(sim,10,"out of memory in molsort\n");return 1;}
+						molstoreput(mols,mptr,ll2,nl[ll2]);
             live[ll2][nl[ll2]++]=mptr;
             mlist[m]=NULL;
             if(listtype[ll2]==MLTsystem) {
@@ -2996,19 +3377,23 @@ int molsort(simptr sim,int onlydead2live) {
 									simLog(sim,10,"out of memory in molsort");return 1;} }}}
 
           mlist[m]=mlist[--topl[ll]];				// compact original live list
+						molstoreput(mols,mlist[m],ll,m);
           mlist[topl[ll]]=mlist[--nl[ll]];
+						if(topl[ll]<nl[ll]) molstoreput(mols,mlist[topl[ll]],ll,topl[ll]);
           mlist[nl[ll]]=NULL;
           m--; }}}}
 
 	for(m=mols->topd;m<mols->nd;m++) {		// move molecules from resurrected to reborn
 		mptr=dead[m];
 		if(mptr->ident==0) {
+			molstoreput(mols,mptr,-1,mols->topd);
 			dead[mols->topd++]=mptr; }
 		else {
 			ll2=mptr->list;
 			if(nl[ll2]==maxl[ll2])
 				if(molexpandlist(mols,sim->dim,ll2,-1,0)) {
 					simLog(sim,10,"out of memory in molsort\n");return 1;}
+			molstoreput(mols,mptr,ll2,nl[ll2]);
 			live[ll2][nl[ll2]++]=mptr;
 			dead[m]=NULL;
 			if(listtype[ll2]==MLTsystem) {
@@ -3023,6 +3408,83 @@ int molsort(simptr sim,int onlydead2live) {
 	return 0; }
 
 
+/* molreorderlist */
+int molreorderlist(simptr sim,int ll) {
+	molssptr mols;
+	boxssptr boxs;
+	boxptr bptr;
+	moleculeptr *mlist,mptr;
+	long int *key,code,q[DIMMAX];
+	int dim,d,m,n,b,bits;
+	double poslo[DIMMAX],poshi[DIMMAX],scale[DIMMAX];
+
+	mols=sim->mols;
+	boxs=sim->boxs;
+	dim=sim->dim;
+	mlist=mols->live[ll];
+	n=mols->topl[ll];													// reborn molecules stay at the top
+	if(n<2) return 0;
+
+	key=(long int*) calloc(n,sizeof(long int));
+	if(!key) return 1;
+
+	if(mols->order==MObox) {									// key is linear box index
+		for(m=0;m<n;m++) {
+			bptr=mlist[m]->box;
+			if(!bptr) key[m]=-1;
+			else {
+				b=0;
+				for(d=0;d<dim;d++) b=boxs->side[d]*b+bptr->indx[d];
+				key[m]=b; }}}
+	else {																		// key is Morton code of position
+		bits=(int)(8*sizeof(long int)-1)/dim;
+		if(bits>20) bits=20;
+		systemcorners(sim,poslo,poshi);
+		for(d=0;d<dim;d++) scale[d]=(double)(1L<<bits)/(poshi[d]-poslo[d]);
+		for(m=0;m<n;m++) {
+			mptr=mlist[m];
+			for(d=0;d<dim;d++) {
+				q[d]=(long int)((mptr->pos[d]-poslo[d])*scale[d]);
+				if(q[d]<0) q[d]=0;
+				else if(q[d]>=(1L<<bits)) q[d]=(1L<<bits)-1; }
+			code=0;
+			for(b=bits-1;b>=0;b--)
+				for(d=0;d<dim;d++)
+					code=(code<<1)|((q[d]>>b)&1);
+			key[m]=code; }}
+
+	sortVliv(key,(void**)mlist,n);
+	free(key);
+
+	if(boxs && mols->listtype[ll]==MLTsystem) {		// refill box lists in new list order
+		for(b=0;b<boxs->nbox;b++) boxs->blist[b]->nmol[ll]=0;
+		n=mols->nl[ll];
+		for(m=0;m<n;m++) {
+			mptr=mlist[m];
+			bptr=mptr->box;
+			if(bptr) {
+				mptr->boxm=bptr->nmol[ll];
+				bptr->mol[ll][bptr->nmol[ll]++]=mptr; }}}
+
+	return molstoresync(mols,ll); }
+
+
+/* molreorder */
+int molreorder(simptr sim) {
+	molssptr mols;
+	int ll,er;
+
+	mols=sim->mols;
+	if(!mols || mols->order==MOnone) return 0;
+	if(++mols->orderct<mols->orderinterval) return 0;
+	mols->orderct=0;
+	for(ll=0;ll<mols->nlist;ll++)
+		if(mols->listtype[ll]==MLTsystem) {
+			er=molreorderlist(sim,ll);
+			if(er) return er; }
+	return 0; }
+
+
 /* moldosurfdrift */
 void moldosurfdrift(simptr sim,moleculeptr mptr,double dt) {
 	int i,s,axis;
@@ -3111,58 +3573,263 @@ void moldosurfdrift(simptr sim,moleculeptr mptr,double dt) {
 	return; }
 
 
-/* diffuse */
-int diffuse(simptr sim) {
+#ifdef MOLSIMDX86
+
+/* moldiffuseblockavx2 */
+__attribute__((target("avx2")))
+static void moldiffuseblockavx2(double *pos,const double *step,const uint32_t *rnd,const double *gtable,uint32_t mask,int n) {
+	int k;
+	__m128i msk,indx;
+	__m256d g;
+
+	msk=_mm_set1_epi32((int)mask);
+	for(k=0;k+4<=n;k+=4) {
+		indx=_mm_and_si128(_mm_loadu_si128((const __m128i*)(rnd+k)),msk);
+		g=_mm256_i32gather_pd(gtable,indx,8);
+		_mm256_storeu_pd(pos+k,_mm256_add_pd(_mm256_loadu_pd(pos+k),_mm256_mul_pd(_mm256_loadu_pd(step+k),g))); }
+	for(;k<n;k++)
+		pos[k]+=step[k]*gtable[rnd[k]&mask];
+	return; }
+
+
+/* moldiffuseblockavx512 */
+__attribute__((target("avx512f")))
+static void moldiffuseblockavx512(double *pos,const double *step,const uint32_t *rnd,const double *gtable,uint32_t mask,int n) {
+	int k;
+	__m256i msk,indx;
+	__m512d g;
+
+	msk=_mm256_set1_epi32((int)mask);
+	for(k=0;k+8<=n;k+=8) {
+		indx=_mm256_and_si256(_mm256_loadu_si256((const __m256i*)(rnd+k)),msk);
+		g=_mm512_i32gather_pd(indx,gtable,8);
+		_mm512_storeu_pd(pos+k,_mm512_add_pd(_mm512_loadu_pd(pos+k),_mm512_mul_pd(_mm512_loadu_pd(step+k),g))); }
+	for(;k<n;k++)
+		pos[k]+=step[k]*gtable[rnd[k]&mask];
+	return; }
+
+#endif
+
+
+/* molsimdlevel */
+int molsimdlevel(void) {
+	if(MolSimdLevel<0) {
+#ifdef MOLSIMDX86
+		__builtin_cpu_init();
+		MolSimdLevel=__builtin_cpu_supports("avx512f")?2:(__builtin_cpu_supports("avx2")?1:0);
+#else
+		MolSimdLevel=0;
+#endif
+		}
+	return MolSimdLevel; }
+
+
+/* moldiffuseblock */
+void moldiffuseblock(double *pos,const double *step,const uint32_t *rnd,const double *gtable,uint32_t mask,int n) {
+	int k;
+#ifdef MOLSIMDX86
+	int simd;
+
+	simd=molsimdlevel();
+	if(simd==2) {
+		moldiffuseblockavx512(pos,step,rnd,gtable,mask,n);
+		return; }
+	if(simd==1) {
+		moldiffuseblockavx2(pos,step,rnd,gtable,mask,n);
+		return; }
+#endif
+
+	for(k=0;k<n;k++)
+		pos[k]+=step[k]*gtable[rnd[k]&mask];
+	return; }
+
+
+/* moldiffuserun */
+static inline int moldiffuserun(simptr sim,int ll,int m,int mmax,uint64_t *stream,const int dim) {
 	molssptr mols;
-	int ll,m,d,nmol,dim,i,ngtablem1;
+	molstoreptr store;
+	moleculeptr *mlist,mptr;
+	int nb,mb,d,j,i,ngtablem1,mixed,aniso;
+	double *gtable,*pos,***drift,***difmstep,**difstep,sum;
+	double step[DIFBLOCK*DIMMAX],gauss[DIFBLOCK*DIMMAX],*mat[DIFBLOCK];
+	uint32_t rnd[DIFBLOCK*DIMMAX];
+
+	mols=sim->mols;
+	mlist=mols->live[ll];
+	store=mols->molstore?mols->livestore[ll]:NULL;
+	drift=mols->drift;
+	difmstep=mols->difmstep;
+	difstep=mols->difstep;
+	mixed=(mols->diffuselist[ll]==2);
+	aniso=(difmstep[mlist[m]->ident][MSsoln]!=NULL);
+	for(nb=0;nb<DIFBLOCK && m+nb<mmax;nb++) {						// gather a block of simple isotropic or anisotropic diffusers
+		mptr=mlist[m+nb];
+		i=mptr->ident;
+		if(mptr->mstate!=MSsoln || mptr->pnl || drift[i][MSsoln]) break;
+		if(mixed && !mols->mobile[i][MSsoln]) break;
+		if((difmstep[i][MSsoln]!=NULL)!=aniso) break;
+		if(aniso)
+			mat[nb]=difmstep[i][MSsoln];
+		else
+			for(d=0;d<dim;d++)
+				step[nb*dim+d]=difstep[i][MSsoln];
+		if(!store)
+			for(d=0;d<dim;d++)
+				mptr->posx[d]=mptr->pos[d];
+		mptr->pnlx=NULL; }
+	if(!nb) return 0;
+
+	if(aniso) {																					// anisotropic, using scaled matrices
+		if(mols->gaussmethod==MGziggurat)
+			gausszigarrayD(gauss,nb*dim,stream);
+		else {
+			ngtablem1=mols->ngausstbl-1;
+			gtable=mols->gausstbl;
+			if(stream) randstreamULIarray(stream,rnd,nb*dim);
+			else randULIarray(rnd,nb*dim);
+			for(d=0;d<nb*dim;d++)
+				gauss[d]=gtable[rnd[d]&ngtablem1]; }
+		for(mb=0;mb<nb;mb++) {
+			pos=store?store->pos+(m+mb)*dim:mlist[m+mb]->pos;
+			for(d=0;d<dim;d++) {
+				sum=0;
+				for(j=0;j<dim;j++)
+					sum+=mat[mb][d*dim+j]*gauss[mb*dim+j];
+				pos[d]+=sum; }}
+		return nb; }
+
+	if(mols->gaussmethod==MGziggurat) {									// exact Gaussian random numbers
+		gausszigarrayD(gauss,nb*dim,stream);
+		if(store) {
+			pos=store->pos+m*dim;
+			for(d=0;d<nb*dim;d++)
+				pos[d]+=step[d]*gauss[d]; }
+		else
+			for(mb=0;mb<nb;mb++) {
+				pos=mlist[m+mb]->pos;
+				for(d=0;d<dim;d++)
+					pos[d]+=step[mb*dim+d]*gauss[mb*dim+d]; }
+		return nb; }
+
+	ngtablem1=mols->ngausstbl-1;												// Gaussian lookup table
+	gtable=mols->gausstbl;
+	if(stream) randstreamULIarray(stream,rnd,nb*dim);
+	else randULIarray(rnd,nb*dim);
+	if(store)
+		moldiffuseblock(store->pos+m*dim,step,rnd,gtable,(uint32_t)ngtablem1,nb*dim);
+	else
+		for(mb=0;mb<nb;mb++) {
+			pos=mlist[m+mb]->pos;
+			for(d=0;d<dim;d++)
+				pos[d]+=step[mb*dim+d]*gtable[rnd[mb*dim+d]&ngtablem1]; }
+	return nb; }
+
+
+/* moldiffuse1mol */
+static inline void moldiffuse1mol(simptr sim,moleculeptr mptr,int copyposx,const int dim) {
+	molssptr mols;
+	int d,i,ngtablem1,zig;
 	enum MolecState ms;
-	double flt1;
-	double v1[DIMMAX],v2[DIMMAX],**difstep,***difm,***drift,*gtable,dt;
-	moleculeptr *mlist;
-	moleculeptr mptr;
+	double v1[DIMMAX],v2[DIMMAX],*gtable,dt;
 
-	if(!sim->mols) return 0;
-	dim=sim->dim;
 	mols=sim->mols;
 	ngtablem1=mols->ngausstbl-1;
 	gtable=mols->gausstbl;
-	difstep=mols->difstep;
-	difm=mols->difm;
-	drift=mols->drift;
-	dt=sim->dt;
-	flt1=sqrt(2.0*dt);
+	zig=(mols->gaussmethod==MGziggurat);
+	dt=sim->dt*(mptr->list>=0?mols->stepmult[mptr->list]:1);				// killed molecules stay listed until sorting
+	i=mptr->ident;
+	ms=mptr->mstate;
+	if(copyposx)
+		for(d=0;d<dim;d++)
+			mptr->posx[d]=mptr->pos[d];
+	mptr->pnlx=mptr->pnl;
+	if(!mols->mobile[i][ms]) return;											// immobile molecules stay put
+
+	if(ms!=MSsoln && dim==3 && mptr->pnl->ps==PStri && sim->srfss->localdiffuse && !mols->difm[i][ms] && !mols->drift[i][ms] && !(mols->surfdrift && mols->surfdrift[i] && mols->surfdrift[i][ms])) {
+		v1[0]=mols->difstep[i][ms]*(zig?gausszigD(NULL):gtable[randULI()&ngtablem1]);	// panel-local diffusion
+		v1[1]=mols->difstep[i][ms]*(zig?gausszigD(NULL):gtable[randULI()&ngtablem1]);
+		movemolonpanels(sim,mptr,v1[0],v1[1]);
+		return; }
+
+	if(mptr->pnl && mols->surfdrift && mols->surfdrift[i] && mols->surfdrift[i][ms])
+		moldosurfdrift(sim,mptr,dt);											// surface drift
+	if(mols->drift[i][ms])																// drift
+		for(d=0;d<dim;d++) mptr->pos[d]+=mols->drift[i][ms][d]*dt;
+
+	if(!mols->difm[i][ms])																// isotropic diffusion
+		for(d=0;d<dim;d++)
+			mptr->pos[d]+=mols->difstep[i][ms]*(zig?gausszigD(NULL):gtable[randULI()&ngtablem1]);
+	else {																								// anisotropic diffusion
+		for(d=0;d<dim;d++)
+			v1[d]=zig?gausszigD(NULL):gtable[randULI()&ngtablem1];
+		dotMVD(mols->difmstep[i][ms],v1,v2,dim,dim);
+		for(d=0;d<dim;d++) mptr->pos[d]+=v2[d]; }
+
+	if(mptr->mstate!=MSsoln) {														// surface-bound molecules
+		if(dim>1)
+			movemol2closepanel(sim,mptr);
+		else
+			mptr->pos[0]=mptr->posx[0]; }										// 1D surface-bound molecules aren't allowed to move
+	return; }
+
+
+/* diffusedim */
+static inline int diffusedim(simptr sim,const int dim) {
+	molssptr mols;
+	molstoreptr store;
+	int ll,m,nb,nmol,nthreads,t;
+	moleculeptr *mlist;
+
+	if(!sim->mols) return 0;
+	mols=sim->mols;
+	nthreads=sim->threadrng?sim->nthreads:1;
+	molsimdlevel();
 
 	for(ll=0;ll<mols->nlist;ll++)
-		if(mols->diffuselist[ll]) {
+		if(mols->diffuselist[ll] && mollistmoves(mols,ll)) {
 			mlist=mols->live[ll];
 			nmol=mols->nl[ll];
-			for(m=0;m<nmol;m++) {
-				mptr=mlist[m];
-				i=mptr->ident;
-				ms=mptr->mstate;
-				for(d=0;d<dim;d++)
-					mptr->posx[d]=mptr->pos[d];
-				mptr->pnlx=mptr->pnl;
-
-				if(mptr->pnl && mols->surfdrift && mols->surfdrift[i] && mols->surfdrift[i][ms])
-					moldosurfdrift(sim,mptr,dt);											// surface drift
-				if(drift[i][ms])																		// drift
-					for(d=0;d<dim;d++) mptr->pos[d]+=drift[i][ms][d]*dt;
-
-				if(!difm[i][ms])																		// isotropic diffusion
-					for(d=0;d<dim;d++)
-						mptr->pos[d]+=difstep[i][ms]*gtable[randULI()&ngtablem1];
-				else {																							// anisotropic diffusion
-					for(d=0;d<dim;d++)
-						v1[d]=flt1*gtable[randULI()&ngtablem1];
-					dotMVD(difm[i][ms],v1,v2,dim,dim);
-					for(d=0;d<dim;d++) mptr->pos[d]+=v2[d]; }
-
-				if(mptr->mstate!=MSsoln) {													// surface-bound molecules
-					if(dim>1)
-						movemol2closepanel(sim,mptr);
-					else
-						mptr->pos[0]=mptr->posx[0]; }}									// 1D surface-bound molecules aren't allowed to move
+			store=mols->molstore?mols->livestore[ll]:NULL;
+			if(store)																					// copy all old positions at once
+				memcpy(store->posx,store->pos,nmol*dim*sizeof(double));
+
+			if(nthreads==1) {																	// single thread
+				for(m=0;m<nmol;) {
+					nb=moldiffuserun(sim,ll,m,nmol,NULL,dim);
+					if(nb) m+=nb;
+					else moldiffuse1mol(sim,mlist[m++],!store,dim); }}
+
+			else {																						// multiple threads
+#ifdef HAVE_OPENMP
+				#pragma omp parallel for num_threads(nthreads) schedule(static,1) private(m,nb)
+#endif
+				for(t=0;t<nthreads;t++)
+					for(m=(int)((long int)nmol*t/nthreads);m<(int)((long int)nmol*(t+1)/nthreads);) {
+						nb=moldiffuserun(sim,ll,m,(int)((long int)nmol*(t+1)/nthreads),sim->threadrng+4*t,dim);
+						m+=nb?nb:1; }
+				for(m=0;m<nmol;m++)															// other molecules, sequentially
+					if(mlist[m]->mstate!=MSsoln || mlist[m]->pnl || mols->drift[mlist[m]->ident][MSsoln] || !mols->mobile[mlist[m]->ident][MSsoln])
+						moldiffuse1mol(sim,mlist[m],!store,dim); }
 			sim->mols->touch++; }
 
 	return 0; }
+
+
+/* diffuse */
+int diffuse(simptr sim) {
+	return diffusedim(sim,sim->dim); }
+
+
+/* diffuse1D */
+int diffuse1D(simptr sim) {
+	return diffusedim(sim,1); }
+
+
+/* diffuse2D */
+int diffuse2D(simptr sim) {
+	return diffusedim(sim,2); }
+
+
+/* diffuse3D */
+int diffuse3D(simptr sim) {
+	return diffusedim(sim,3); }
@@ -484,7 +484,8 @@ int portputmols(simptr sim,portptr port,int nmol,int ident,int *species,double *
 			pnl=surfrandpos(port->srf,mptr->posx,dim);
 			fixpt2panel(mptr->posx,pnl,dim,port->face,sim->srfss->epsilon);
 			for(d=0;d<dim;d++) mptr->pos[d]=mptr->posx[d]; }
-		mptr->box=pos2box(sim,mptr->pos); }
+		mptr->box=pos2box(sim,mptr->pos);
+		molcountadd(sim->mols,mptr); }
 	sim->eventcount[ETimport]+=nmol;
 	return 0; }
 
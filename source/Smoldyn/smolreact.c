@@ -68,6 +68,8 @@ rxnptr RxnTestRxnExist(simptr sim,int order,const char *rname,const int *rctiden
 
 // core simulation functions
 int morebireact(simptr sim,rxnptr rxn,moleculeptr mptr1,moleculeptr mptr2,int ll1,int m1,int ll2,enum EventType et,double *vect);
+static inline int rxnlistpairmoves(molssptr mols,int ll1,int ll2);
+static inline int bireactdim(simptr sim,int neigh,const int dim);
 
 
 /******************************************************************************/
@@ -890,7 +892,7 @@ void rxnoutput(simptr sim,int order) {
 			i1=rxn->rctident[0];
 			i2=rxn->rctident[1];
 			dsum=MolCalcDifcSum(sim,i1,ms1,i2,ms2);
-			step=sqrt(2.0*dsum*sim->dt);
+			step=sqrt(2.0*dsum*sim->dt*molpairstepmult(sim,i1,ms1,i2,ms2));
 			ratio=step/sqrt(rxn->bindrad2);
 			rate3=actualrate;
 			if(i1==i2) rate3*=2;																		// rate3 is actual rate constant, corrected here for same reactants
@@ -931,7 +933,7 @@ void rxnoutput(simptr sim,int order) {
 				revrxn=sim->rxnss[2]->rxn[rr];
 				if(revrxn->bindrad2>=0 && revrxn->rparamt!=RPconfspread) {
 					dsum=MolCalcDifcSum(sim,rxn->prdident[0],rxn->prdstate[0],rxn->prdident[1],rxn->prdstate[1]);
-					step=sqrt(2.0*sim->dt*dsum);
+					step=sqrt(2.0*sim->dt*molpairstepmult(sim,rxn->prdident[0],rxn->prdstate[0],rxn->prdident[1],rxn->prdstate[1])*dsum);
 					pgem=1.0-numrxnrateprob(step,sqrt(revrxn->bindrad2),-1,revrxn->prob)/numrxnrateprob(step,sqrt(revrxn->bindrad2),rxn->unbindrad,revrxn->prob);	// phi = 1-k_i/k_r
 					rev=(revrxn->nprod==order);
 					rev=rev && Zn_sameset(revrxn->prdident,rxn->rctident,identlist,order);
@@ -1308,7 +1310,7 @@ int rxnsetrate(simptr sim,int order,int r,char *erstr) {
 	rxnssptr rxnss;
 	int i,j,i1,i2,rev,o2,r2,permit;
 	rxnptr rxn,rxn2,revrxn;
-	double vol,rate3,dsum,rparam,unbindrad,prob,product,sum;
+	double vol,rate3,dsum,rparam,unbindrad,prob,product,sum,dt;
 	enum MolecState ms,ms1,ms2,statelist[MAXORDER];
 	enum RevParam rparamt;
 
@@ -1376,6 +1378,7 @@ int rxnsetrate(simptr sim,int order,int r,char *erstr) {
 		if(i1==i2) rate3*=2;				// same reactants
 		if((ms1==MSsoln && ms2!=MSsoln) || (ms1!=MSsoln && ms2==MSsoln)) rate3*=2;	// one surface, one solution
 		dsum=MolCalcDifcSum(sim,i1,ms1,i2,ms2);
+		dt=sim->dt*molpairstepmult(sim,i1,ms1,i2,ms2);		// effective time step for this reactant pair
 		rev=findreverserxn(sim,2,r,&o2,&r2);		// rev is 0 for irreversible, 1 for direct reverse reaction, 2 for continuation reaction
 
 		if(rev>0 && o2==2) {						// set own reversible parameter if needed
@@ -1398,14 +1401,14 @@ int rxnsetrate(simptr sim,int order,int r,char *erstr) {
 		if(!permit) rxn->bindrad2=0;
 		else if(rate3<=0) rxn->bindrad2=0;
 		else if(dsum<=0) {snprintf(erstr,STRCHAR*sizeof(erstr),"Both diffusion coefficients are 0");return 4;}
-		else if(rparamt==RPunbindrad) rxn->bindrad2=bindingradiusprob(rate3,sim->dt,dsum,rparam,0,rxn->chi,&rxn->prob);
-		else if(rparamt==RPratio) rxn->bindrad2=bindingradiusprob(rate3,sim->dt,dsum,rparam,1,rxn->chi,&rxn->prob);
-		else if(rparamt==RPpgem) rxn->bindrad2=bindingradiusprob(rate3*(1.0-rparam),sim->dt,dsum,-1,0,rxn->chi,&rxn->prob);
+		else if(rparamt==RPunbindrad) rxn->bindrad2=bindingradiusprob(rate3,dt,dsum,rparam,0,rxn->chi,&rxn->prob);
+		else if(rparamt==RPratio) rxn->bindrad2=bindingradiusprob(rate3,dt,dsum,rparam,1,rxn->chi,&rxn->prob);
+		else if(rparamt==RPpgem) rxn->bindrad2=bindingradiusprob(rate3*(1.0-rparam),dt,dsum,-1,0,rxn->chi,&rxn->prob);
 		else if(rparamt==RPpgemmax || rparamt==RPpgemmaxw) {
-			rxn->bindrad2=bindingradiusprob(rate3,sim->dt,dsum,0,0,rxn->chi,&rxn->prob);
-			unbindrad=unbindingradius(rparam,sim->dt,dsum,rxn->bindrad2);
-			if(unbindrad>0) rxn->bindrad2=bindingradiusprob(rate3*(1.0-rparam),sim->dt,dsum,-1,0,rxn->chi,&rxn->prob); }
-		else rxn->bindrad2=bindingradiusprob(rate3,sim->dt,dsum,-1,0,rxn->chi,&rxn->prob);					// irreversible or assumed irreversible
+			rxn->bindrad2=bindingradiusprob(rate3,dt,dsum,0,0,rxn->chi,&rxn->prob);
+			unbindrad=unbindingradius(rparam,dt,dsum,rxn->bindrad2);
+			if(unbindrad>0) rxn->bindrad2=bindingradiusprob(rate3*(1.0-rparam),dt,dsum,-1,0,rxn->chi,&rxn->prob); }
+		else rxn->bindrad2=bindingradiusprob(rate3,dt,dsum,-1,0,rxn->chi,&rxn->prob);					// irreversible or assumed irreversible
 
 		rxn->bindrad2*=rxn->bindrad2; }
 
@@ -1432,7 +1435,7 @@ int rxnsetproduct(simptr sim,int order,int r,char *erstr) {
 	rxnssptr rxnss;
 	rxnptr rxn,rxnr;
 	int er,dim,nprod,orderr,rr,rev,d,prd;
-	double rpar,dc1,dc2,dsum,bindradr,dist;
+	double rpar,dc1,dc2,dsum,bindradr,dist,dt;
 	enum RevParam rparamt;
 	enum MolecState ms1,ms2;
 
@@ -1506,6 +1509,7 @@ int rxnsetproduct(simptr sim,int order,int r,char *erstr) {
 		else {
 			dc1/=dsum;				// dc1 and dc2 are diffusion coefficients relative to dsum
 			dc2/=dsum; }
+		dt=sim->dt*molpairstepmult(sim,rxn->prdident[0],ms1,rxn->prdident[1],ms2);
 		rev=findreverserxn(sim,order,r,&orderr,&rr);
 
 		if(rparamt==RPirrev || rparamt==RPconfspread) {	// nprod>=2, irrev or confspread
@@ -1550,7 +1554,7 @@ int rxnsetproduct(simptr sim,int order,int r,char *erstr) {
 			else if(dsum<=0) {						// all below options require dsum > 0
 				snprintf(erstr,STRCHAR*sizeof(erstr),"Cannot set unbinding distance because sum of product diffusion constants is 0");er=4; }
 			else if(rparamt==RPpgem || rparamt==RPpgem2) {
-				rpar=unbindingradius(rpar,sim->dt,dsum,bindradr);
+				rpar=unbindingradius(rpar,dt,dsum,bindradr);
 				if(rpar==-2) {
 					snprintf(erstr,STRCHAR*sizeof(erstr),"Cannot create an unbinding radius due to illegal input values");er=7; }
 				else if(rpar<0) {
@@ -1560,7 +1564,7 @@ int rxnsetproduct(simptr sim,int order,int r,char *erstr) {
 					rxn->prdpos[0][0]=rpar*dc1;
 					rxn->prdpos[1][0]=-rpar*dc2; }}
 			else if(rparamt==RPpgemmax || rparamt==RPpgemmaxw || rparamt==RPpgemmax2) {
-				rpar=unbindingradius(rpar,sim->dt,dsum,bindradr);
+				rpar=unbindingradius(rpar,dt,dsum,bindradr);
 				if(rpar==-2) {
 					snprintf(erstr,STRCHAR*sizeof(erstr),"Illegal input values");er=9; }
 				else if(rpar<=0) {
@@ -1593,7 +1597,7 @@ double rxncalcrate(simptr sim,int order,int r,double *pgemptr) {
 	rxnssptr rxnss;
 	double ans,vol;
 	int i1,i2,i,j,r2,rev,o2,permit;
-	double step,a,bval,product,probthisrxn,prob,sum,ratesum;
+	double step,a,bval,product,probthisrxn,prob,sum,ratesum,dt;
 	rxnptr rxn,rxnr,rxn2;
 	enum MolecState ms1,ms2,statelist[MAXORDER];
 	enum RevParam rparamt;
@@ -1642,8 +1646,9 @@ double rxncalcrate(simptr sim,int order,int r,double *pgemptr) {
 			ms1=statelist[0];
 			ms2=statelist[1];
 			if(!permit) return 0;
-			if(rxn->rparamt==RPconfspread) return -log(1.0-rxn->prob)/sim->dt;
-			step=sqrt(2.0*MolCalcDifcSum(sim,i1,ms1,i2,ms2)*sim->dt);
+			dt=sim->dt*molpairstepmult(sim,i1,ms1,i2,ms2);
+			if(rxn->rparamt==RPconfspread) return -log(1.0-rxn->prob)/dt;
+			step=sqrt(2.0*MolCalcDifcSum(sim,i1,ms1,i2,ms2)*dt);
 			a=sqrt(rxn->bindrad2);
 			rev=findreverserxn(sim,order,r,&o2,&r2);
 			prob=rxn->prob;
@@ -1656,9 +1661,9 @@ double rxncalcrate(simptr sim,int order,int r,double *pgemptr) {
 			if(rparamt==RPpgem || rparamt==RPpgemmax || rparamt==RPpgemmaxw || rparamt==RPratio || rparamt==RPunbindrad) {	// list was changed in version 2.56 to agree with Smoldyn User's manual
 				rxnr=sim->rxnss[o2]->rxn[r2];
 				bval=distanceVVD(rxnr->prdpos[0],rxnr->prdpos[1],sim->dim);
-				ans=numrxnrateprob(step,a,bval,prob)/sim->dt; }
+				ans=numrxnrateprob(step,a,bval,prob)/dt; }
 			else
-				ans=numrxnrateprob(step,a,-1,prob)/sim->dt;
+				ans=numrxnrateprob(step,a,-1,prob)/dt;
 			if(i1==i2) ans/=2.0;
 			if(!rxn->permit[MSsoln*MSMAX1+MSsoln]) ans/=2.0; }}
 
@@ -1667,7 +1672,7 @@ double rxncalcrate(simptr sim,int order,int r,double *pgemptr) {
 	if(pgemptr) {
 		if(rxn->nprod!=2 || findreverserxn(sim,order,r,&o2,&r2)==0) *pgemptr=-1;
 		else {
-			step=sqrt(2.0*MolCalcDifcSum(sim,rxn->prdident[0],rxn->prdstate[0],rxn->prdident[1],rxn->prdstate[1])*sim->dt);
+			step=sqrt(2.0*MolCalcDifcSum(sim,rxn->prdident[0],rxn->prdstate[0],rxn->prdident[1],rxn->prdstate[1])*sim->dt*molpairstepmult(sim,rxn->prdident[0],rxn->prdstate[0],rxn->prdident[1],rxn->prdstate[1]));
 			bval=distanceVVD(rxn->prdpos[0],rxn->prdpos[1],sim->dim);
 			rxnr=sim->rxnss[o2]->rxn[r2];
 			a=sqrt(rxnr->bindrad2);
@@ -2289,7 +2294,7 @@ failure:
 
 /* rxnsupdateparams */
 int rxnsupdateparams(simptr sim) {
-	int er,order,wflag;
+	int er,order,wflag,r;
 	char errorstr[STRCHAR];
 
 	wflag=strchr(sim->flags,'w')?1:0;
@@ -2313,6 +2318,13 @@ int rxnsupdateparams(simptr sim) {
 		if(sim->rxnss[order] && sim->rxnss[order]->condition<=SCparams)
 			rxncalctau(sim,order);
 
+	if(sim->boxs && sim->boxs->edge && sim->rxnss[2])		// adapted boxes need to be as wide as binding radii
+		for(r=0;r<sim->rxnss[2]->totrxn;r++)
+			if(sim->rxnss[2]->rxn[r]->bindrad2>sim->boxs->adaptrad*sim->boxs->adaptrad) {
+				boxsetcondition(sim->boxs,SClists,0);
+				compartsetcondition(sim->cmptss,SCparams,0);
+				break; }
+
 	return 0; }
 
 
@@ -2875,6 +2887,7 @@ int doreact(simptr sim,rxnptr rxn,moleculeptr mptr1,moleculeptr mptr2,int ll1,in
 				pserno=rxn->prdserno[prd];
 				mptr->serno=molfindserno(sim,mptr->serno,pserno,mptr1?mptr1->serno:0,mptr2?mptr2->serno:0,sernolist);
 				sernolist[prd]=mptr->serno; }}
+		molcountadd(sim->mols,mptr);
 
 		if(rxn->logserno) {													// log reaction if needed
 			if(dorxnlog==0 && (ListMemberLI(rxn->logserno,mptr->serno&0xFFFFFFFF) || (mptr->serno>0xFFFFFFF && ListMemberLI(rxn->logserno,mptr->serno>>32))))
@@ -3197,9 +3210,17 @@ void setBiReactRateForHybrid(simptr sim,rxnptr rxn,moleculeptr mptr1,moleculeptr
 #endif
 
 
-/* bireact */
-int bireact(simptr sim,int neigh) {
-	int dim,maxspecies,ll1,ll2,i,j,d,*nl,nmol2,b2,m1,m2,bmax,wpcode,nlist,maxlist;
+/* rxnlistpairmoves */
+static inline int rxnlistpairmoves(molssptr mols,int ll1,int ll2) {
+	int mult;
+
+	mult=mols->stepmult[ll1]<mols->stepmult[ll2]?mols->stepmult[ll1]:mols->stepmult[ll2];
+	return mult==1 || mols->stepct%mult==0; }
+
+
+/* bireactdim */
+static inline int bireactdim(simptr sim,int neigh,const int dim) {
+	int maxspecies,ll1,ll2,i,j,d,*nl,nmol2,b2,m1,m2,bmax,wpcode,nlist,maxlist;
 	int *nrxn,**table;
 	double dist2,vect[DIMMAX];
 	rxnssptr rxnss;
@@ -3209,7 +3230,6 @@ int bireact(simptr sim,int neigh) {
 
 	rxnss=sim->rxnss[2];
 	if(!rxnss) return 0;
-	dim=sim->dim;
 	live=sim->mols->live;
 	maxspecies=rxnss->maxspecies;
 	maxlist=rxnss->maxlist;
@@ -3222,7 +3242,7 @@ int bireact(simptr sim,int neigh) {
 	if(!neigh) {																		// same box
 		for(ll1=0;ll1<nlist;ll1++)
 			for(ll2=ll1;ll2<nlist;ll2++)
-				if(rxnss->rxnmollist[ll1*maxlist+ll2])
+				if(rxnss->rxnmollist[ll1*maxlist+ll2] && rxnlistpairmoves(sim->mols,ll1,ll2))
 					for(m1=0;m1<nl[ll1];m1++) {
 						mptr1=live[ll1][m1];
 						bptr=mptr1->box;
@@ -3248,7 +3268,7 @@ int bireact(simptr sim,int neigh) {
 	else {																					// neighbor box
 		for(ll1=0;ll1<nlist;ll1++)
 			for(ll2=ll1;ll2<nlist;ll2++)
-				if(rxnss->rxnmollist[ll1*maxlist+ll2])
+				if(rxnss->rxnmollist[ll1*maxlist+ll2] && rxnlistpairmoves(sim->mols,ll1,ll2))
 					for(m1=0;m1<nl[ll1];m1++) {
 						mptr1=live[ll1][m1];
 						bptr=mptr1->box;
@@ -3296,3 +3316,23 @@ int bireact(simptr sim,int neigh) {
 	return 0; }
 
 
+/* bireact */
+int bireact(simptr sim,int neigh) {
+	return bireactdim(sim,neigh,sim->dim); }
+
+
+/* bireact1D */
+int bireact1D(simptr sim,int neigh) {
+	return bireactdim(sim,neigh,1); }
+
+
+/* bireact2D */
+int bireact2D(simptr sim,int neigh) {
+	return bireactdim(sim,neigh,2); }
+
+
+/* bireact3D */
+int bireact3D(simptr sim,int neigh) {
+	return bireactdim(sim,neigh,3); }
+
+
@@ -269,8 +269,13 @@ double simversionnumber(void) {
 
 /* Simsetrandseed */
 void Simsetrandseed(simptr sim,long int randseed) {
+	int t;
+
 	if(!sim) return;
 	sim->randseed=randomize(randseed);
+	if(sim->threadrng)
+		for(t=0;t<sim->nthreads;t++)
+			randstreaminit(sim->threadrng+4*t,(uint64_t)sim->randseed,t);
 	return; }
 
 
@@ -294,6 +299,8 @@ simptr simalloc(const char *fileroot) {
 	sim->flags=NULL;
 	sim->clockstt=time(NULL);
 	sim->elapsedtime=0;
+	sim->nthreads=1;
+	sim->threadrng=NULL;
 	Simsetrandseed(sim,-1);
 	for(et=(EventType)0;et<ETMAX;et=(EventType)(et+1)) sim->eventcount[et]=0;
 	sim->maxvar=0;
@@ -387,6 +394,7 @@ void simfree(simptr sim) {
 #endif
 
 	free(sim->varvalues);
+	free(sim->threadrng);
 	free(sim->flags);
 	free(sim->filename);
 	free(sim->filepath);
@@ -456,6 +464,11 @@ void simoutput(simptr sim) {
 	if(sim->accur<10) simLog(sim,2," Accuracy level: %g\n",sim->accur);
 	else simLog(sim,1," Accuracy level: %g\n",sim->accur);
 	simLog(sim,2," Random number seed: %li\n",sim->randseed);
+#ifdef HAVE_OPENMP
+	if(sim->nthreads>1) simLog(sim,2," Diffusion uses %i threads\n",sim->nthreads);
+#else
+	if(sim->nthreads>1) simLog(sim,2," Diffusion uses %i random number streams, run sequentially because this build does not support threads\n",sim->nthreads);
+#endif
 	simLog(sim,sim->nvar>5?2:1," %i variable%s defined:\n",sim->nvar,sim->nvar>1?"s":"");
 	for(v=0;v<sim->nvar && v<5;v++)
 		simLog(sim,1,"  %s = %g\n",sim->varnames[v],sim->varvalues[v]);
@@ -514,8 +527,13 @@ void writesim(simptr sim,FILE *fptr) {
 	fprintf(fptr,"time_step %g\n",sim->dt);
 	fprintf(fptr,"time_now %g\n",sim->time);
 	fprintf(fptr,"accuracy %g\n",sim->accur);
+	if(sim->nthreads>1) fprintf(fptr,"threads %i\n",sim->nthreads);
 	if(sim->boxs->mpbox) fprintf(fptr,"molperbox %g\n",sim->boxs->mpbox);
 	else if(sim->boxs->boxsize) fprintf(fptr,"boxsize %g\n",sim->boxs->boxsize);
+	if(sim->boxs->tunesteps) fprintf(fptr,"box_autotune %i %g\n",sim->boxs->tunesteps,sim->boxs->tunethresh);
+	if(sim->boxs->cellstore) fprintf(fptr,"box_store contiguous\n");
+	if(sim->boxs->adapt) fprintf(fptr,"box_widths adaptive\n");
+	if(sim->boxs->sparse) fprintf(fptr,"box_alloc sparse\n");
 	fprintf(fptr,"\n");
 	return; }
 
@@ -622,6 +640,40 @@ int simsettime(simptr sim,double time,int code) {
 	return er; }
 
 
+/* simsetthreads */
+int simsetthreads(simptr sim,int nthreads) {
+	uint64_t *newrng;
+	int t;
+
+	if(nthreads<1) return 2;
+	newrng=NULL;
+	if(nthreads>1) {
+		newrng=(uint64_t*) calloc(4*nthreads,sizeof(uint64_t));
+		if(!newrng) return 1;
+		for(t=0;t<nthreads;t++)
+			randstreaminit(newrng+4*t,(uint64_t)sim->randseed,t); }
+	free(sim->threadrng);
+	sim->threadrng=newrng;
+	sim->nthreads=nthreads;
+	return 0; }
+
+
+/* simsetfunctions */
+void simsetfunctions(simptr sim) {
+	int dim;
+
+	dim=sim->dim;
+	if(sim->diffusefn==&diffuse)
+		sim->diffusefn=(dim==1)?&diffuse1D:((dim==2)?&diffuse2D:&diffuse3D);
+	if(sim->assignmols2boxesfn==&reassignmolecs)
+		sim->assignmols2boxesfn=(dim==1)?&reassignmolecs1D:((dim==2)?&reassignmolecs2D:&reassignmolecs3D);
+	if(sim->bimolreactfn==&bireact)
+		sim->bimolreactfn=(dim==1)?&bireact1D:((dim==2)?&bireact2D:&bireact3D);
+	if(sim->checkwallsfn==&checkwalls)
+		sim->checkwallsfn=(dim==1)?&checkwalls1D:((dim==2)?&checkwalls2D:&checkwalls3D);
+	return; }
+
+
 /* simreadstring */
 int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 	char nm[STRCHAR],nm1[STRCHAR],shapenm[STRCHAR],ch,rname[STRCHAR],fname[STRCHAR],pattern[STRCHAR];
@@ -635,6 +687,8 @@ int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 	enum PanelShape ps;
 	enum RevParam rpart;
 	enum LightParam ltparam;
+	enum MolOrder mo;
+	enum MolGauss mg;
 	enum SpeciesRepresentation replist[MAXORDER+MAXPRODUCT];
 	rxnptr rxn;
 	compartptr cmpt;
@@ -1143,6 +1197,16 @@ int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 		CHECKS(!er,"out of memory in mol_list_rule");
 		CHECKS(!strnword(line2,2),"unexpected text following mol_list_rule"); }
 
+	else if(!strcmp(word,"mol_list_step")) {				// mol_list_step
+		CHECKS(sim->mols && sim->mols->nlist>0,"need to enter molecule_lists before mol_list_step");
+		itct=sscanf(line2,"%s %i",nm,&i1);
+		CHECKS(itct==2,"mol_list_step format: list_name multiple");
+		ll=stringfind(sim->mols->listname,sim->mols->nlist,nm);
+		CHECKS(ll>=0,"molecule list name is not recognized");
+		er=molsetliststep(sim,ll,i1);
+		CHECKS(er!=2,"time step multiple needs to be at least 1");
+		CHECKS(!strnword(line2,3),"unexpected text following mol_list_step"); }
+
 	// graphics
 
 	else if(!strcmp(word,"graphics")) {						// graphics
@@ -2193,6 +2257,14 @@ int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 		Simsetrandseed(sim,li1);
 		CHECKS(!strnword(line2,2),"unexpected text following random_seed"); }
 
+	else if(!strcmp(word,"threads")) {						// threads
+		itct=strmathsscanf(line2,"%mi",varnames,varvalues,nvar,&i1);
+		CHECKS(itct==1,"threads needs to be an integer");
+		er=simsetthreads(sim,i1);
+		CHECKS(er!=1,"out of memory allocating random number streams for threads");
+		CHECKS(er!=2,"the number of threads needs to be at least 1");
+		CHECKS(!strnword(line2,2),"unexpected text following threads"); }
+
 	else if(!strcmp(word,"accuracy")) {						// accuracy
 		itct=strmathsscanf(line2,"%mlg|",varnames,varvalues,nvar,&flt1);
 		CHECKM(itct==1,"accuracy needs to be a number. ");
@@ -2217,6 +2289,49 @@ int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 		CHECKS(er!=3,"need to enter dim before boxsize");
 		CHECKS(!strnword(line2,2),"unexpected text following boxsize"); }
 
+	else if(!strcmp(word,"box_autotune")) {				// box_autotune
+		flt1=0.5;
+		itct=strmathsscanf(line2,"%mi %mlg",varnames,varvalues,nvar,&i1,&flt1);
+		CHECKS(itct>=1,"box_autotune format: steps [threshold]");
+		er=boxsetautotune(sim,i1,flt1);
+		CHECKS(er!=1,"out of memory");
+		CHECKS(er!=2,"box_autotune steps needs to be >=0 and threshold needs to be >0");
+		CHECKS(er!=3,"need to enter dim before box_autotune");
+		CHECKS(!strnword(line2,itct+1),"unexpected text following box_autotune"); }
+
+	else if(!strcmp(word,"box_store")) {					// box_store
+		CHECKS(dim>0,"need to enter dim before box_store");
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"box_store format: contiguous or separate");
+		if(!strcmp(nm,"contiguous")) i1=1;
+		else if(!strcmp(nm,"separate")) i1=0;
+		else CHECKS(0,"box_store format: contiguous or separate");
+		er=boxsetcellstore(sim,i1);
+		CHECKS(er!=1,"out of memory");
+		CHECKS(!strnword(line2,2),"unexpected text following box_store"); }
+
+	else if(!strcmp(word,"box_widths")) {					// box_widths
+		CHECKS(dim>0,"need to enter dim before box_widths");
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"box_widths format: uniform or adaptive");
+		if(!strcmp(nm,"adaptive")) i1=1;
+		else if(!strcmp(nm,"uniform")) i1=0;
+		else CHECKS(0,"box_widths format: uniform or adaptive");
+		er=boxsetadapt(sim,i1);
+		CHECKS(er!=1,"out of memory");
+		CHECKS(!strnword(line2,2),"unexpected text following box_widths"); }
+
+	else if(!strcmp(word,"box_alloc")) {					// box_alloc
+		CHECKS(dim>0,"need to enter dim before box_alloc");
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"box_alloc format: full or sparse");
+		if(!strcmp(nm,"sparse")) i1=1;
+		else if(!strcmp(nm,"full")) i1=0;
+		else CHECKS(0,"box_alloc format: full or sparse");
+		er=boxsetsparse(sim,i1);
+		CHECKS(er!=1,"out of memory");
+		CHECKS(!strnword(line2,2),"unexpected text following box_alloc"); }
+
 	else if(!strcmp(word,"gauss_table_size")) {		// gauss_table_size
 		itct=strmathsscanf(line2,"%mi",varnames,varvalues,nvar,&i1);
 		CHECKM(itct==1,"gauss_table_size needs to be an integer. ");
@@ -2226,6 +2341,44 @@ int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 		CHECKS(er!=3,"gauss_table_size needs to be an integer power of two");
 		CHECKS(!strnword(line2,2),"unexpected text following gauss_table_size"); }
 
+	else if(!strcmp(word,"rand_gaussian")) {			// rand_gaussian
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"rand_gaussian needs to be table or ziggurat");
+		mg=molstring2gauss(nm);
+		CHECKS(mg!=MGtable || !strcmp(nm,"table"),"rand_gaussian needs to be table or ziggurat");
+		er=molsetgaussmethod(sim,mg);
+		CHECKS(er!=1,"out of memory");
+		CHECKS(!strnword(line2,2),"unexpected text following rand_gaussian"); }
+
+	else if(!strcmp(word,"molecule_store")) {			// molecule_store
+		CHECKS(dim>0,"need to enter dim before molecule_store");
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"molecule_store format: contiguous or separate");
+		if(!strcmp(nm,"contiguous")) i1=1;
+		else if(!strcmp(nm,"separate")) i1=0;
+		else CHECKS(0,"molecule_store format: contiguous or separate");
+		er=molsetstore(sim,i1);
+		CHECKS(er!=1,"out of memory");
+		CHECKS(!er,"BUG: failed to set molecule store");
+		CHECKS(!strnword(line2,2),"unexpected text following molecule_store"); }
+
+	else if(!strcmp(word,"molecule_order")) {			// molecule_order
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"molecule_order format: method [interval]");
+		mo=molstring2order(nm);
+		CHECKS(mo!=MOnone || !strcmp(nm,"none"),"molecule_order method needs to be box, morton, or none");
+		i1=100;
+		line2=strnword(line2,2);
+		if(line2 && mo!=MOnone) {
+			itct=strmathsscanf(line2,"%mi",varnames,varvalues,nvar,&i1);
+			CHECKS(itct==1,"molecule_order format: method [interval]");
+			line2=strnword(line2,2); }
+		er=molsetorder(sim,mo,i1);
+		CHECKS(er!=1,"out of memory");
+		CHECKS(er!=2,"molecule_order interval needs to be at least 1");
+		CHECKS(!er,"BUG: failed to set molecule order");
+		CHECKS(!line2,"unexpected text following molecule_order"); }
+
 	else if(!strcmp(word,"epsilon")) {						// epsilon
 		CHECKS(dim>0,"need to enter dim before epsilon");
 		itct=strmathsscanf(line2,"%mlg|L",varnames,varvalues,nvar,&flt1);
@@ -2253,6 +2406,17 @@ int simreadstring(simptr sim,ParseFilePtr pfp,const char *word,char *line2) {
 		CHECKS(er!=3,"neighdist value needs to be at least 0");
 		CHECKS(!strnword(line2,2),"unexpected text following neighbor_dist"); }
 
+	else if(!strcmp(word,"surface_diffusion")) {			// surface_diffusion
+		CHECKS(dim>0,"need to enter dim before surface_diffusion");
+		itct=sscanf(line2,"%s",nm);
+		CHECKS(itct==1,"surface_diffusion format: method");
+		if(!strcmp(nm,"local")) i1=1;
+		else if(!strcmp(nm,"projection")) i1=0;
+		else CHECKS(0,"surface_diffusion method needs to be 'local' or 'projection'");
+		er=surfsetlocaldiffuse(sim,i1);
+		CHECKS(er!=2,"out of memory");
+		CHECKS(!strnword(line2,2),"unexpected text following surface_diffusion"); }
+
 	else {																				// unknown word
 		CHECKS(0,"syntax error: statement not recognized"); }
 
@@ -2386,6 +2550,8 @@ int simupdate(simptr sim) {
 	CHECK(er!=1);
 	CHECKS(er!=3,"simulation dimensions or boundaries are undefined");
 
+	simsetfunctions(sim);
+
 	er=molsort(sim,0);
 	CHECK(er!=1);
 
@@ -2605,7 +2771,9 @@ void debugcode(simptr sim,const char *prefix) {
 
 /* simulatetimestep */
 int simulatetimestep(simptr sim) {
-	int er,ll;
+	int er,ll,tune;
+	clock_t tunestart;
+	double tunecost;
 
 	er=RuleExpandRules(sim,-3);											// expand any reaction rules if needed
 	if(er && er!=-41) return 13;
@@ -2613,12 +2781,18 @@ int simulatetimestep(simptr sim) {
 	er=simupdate(sim);															// update any data structure changes
 	if(er) return 8;
 
+	if(sim->mols) sim->mols->stepct++;							// count time steps for multi-rate lists
+
 	er=(*sim->diffusefn)(sim);											// diffuse
 	if(er) return 9;
 
+	tune=sim->boxs && sim->boxs->tunesteps;				// time box-dependent work for autotuning
+	tunecost=0;
+	tunestart=tune?clock():0;
+
 	if(sim->srfss) {																// deal with surface or wall collisions
 		for(ll=0;ll<sim->srfss->nmollist;ll++) {
-			if(sim->srfss->srfmollist[ll] & SMLdiffuse) {
+			if((sim->srfss->srfmollist[ll] & SMLdiffuse) && mollistmoves(sim->mols,ll)) {
 		    (*sim->surfacecollisionsfn)(sim,ll,0); }}
 		for(ll=0;ll<sim->srfss->nmollist;ll++)				// surface-bound molecule actions
 			if(sim->srfss->srfmollist[ll] & SMLsrfbound)
@@ -2626,11 +2800,12 @@ int simulatetimestep(simptr sim) {
 	else {
 		if(sim->mols)
 			for(ll=0;ll<sim->mols->nlist;ll++)
-				if(sim->mols->diffuselist[ll])
+				if(sim->mols->diffuselist[ll] && mollistmoves(sim->mols,ll))
 					(*sim->checkwallsfn)(sim,ll,0,NULL); }
 
 	er=(*sim->assignmols2boxesfn)(sim,1,0);					// assign to boxes (diffusing molecs., not reborn)
 	if(er) return 2;
+	if(tune) tunecost+=(double)(clock()-tunestart);
 
 	er=molsort(sim,0);	// sort live and dead
 	if(er) return 6;
@@ -2641,14 +2816,19 @@ int simulatetimestep(simptr sim) {
 	er=(*sim->unimolreactfn)(sim);
 	if(er) return 4;
 
+	if(tune) tunestart=clock();
 	er=(*sim->bimolreactfn)(sim,0);
 	if(er) return 5;
 	er=(*sim->bimolreactfn)(sim,1);
 	if(er) return 5;
+	if(tune) tunecost+=(double)(clock()-tunestart);
 
 	er=molsort(sim,0);																// sort live and dead
 	if(er) return 6;
 
+	er=molreorder(sim);															// spatially reorder live lists
+	if(er) return 6;
+
 	if(sim->latticess) {
 		er=latticeruntimestep(sim);
 		if(er) return 12;
@@ -2666,6 +2846,10 @@ int simulatetimestep(simptr sim) {
 	er=(*sim->assignmols2boxesfn)(sim,0,1);					// assign again (all, reborn)
 	if(er) return 2;
 
+	if(tune) {
+		er=boxesautotune(sim,tunecost/CLOCKS_PER_SEC);
+		if(er) return 8; }
+
 	er=filDynamics(sim);
 	if(er) return 11;
 
@@ -66,6 +66,7 @@ int surfsetmaxpanel(surfaceptr srf,int dim,enum PanelShape ps,int maxpanel);
 int surfsetemitterabsorption(simptr sim);
 double srfcalcrate(simptr sim,surfaceptr srf,int i,enum MolecState ms1,enum PanelFace face,enum MolecState ms2);
 double srfcalcprob(simptr sim,surfaceptr srf,int i,enum MolecState ms1,enum PanelFace face,enum MolecState ms2);
+void surfsetedgeneighbors(simptr sim);
 int surfupdateparams(simptr sim);
 int surfupdatelists(simptr sim);
 
@@ -901,7 +902,9 @@ int panelsalloc(surfaceptr srf,int dim,int maxpanel,int maxspecies,enum PanelSha
 		pnl->front[0]=pnl->front[1]=pnl->front[2]=0;
 		pnl->oldfront[0]=pnl->oldfront[1]=pnl->oldfront[2]=0;
 		pnl->jumpp[0]=pnl->jumpp[1]=NULL;
-		pnl->jumpf[0]=pnl->jumpf[1]=PFnone; }
+		pnl->jumpf[0]=pnl->jumpf[1]=PFnone;
+		pnl->edgeneigh[0]=pnl->edgeneigh[1]=pnl->edgeneigh[2]=NULL;
+		pnl->edgeneighside[0]=pnl->edgeneighside[1]=pnl->edgeneighside[2]=-2; }
 
 	srf->maxpanel[ps]=maxpanel;
 	free(srf->pname[ps]);
@@ -1235,6 +1238,7 @@ surfacessptr surfacessalloc(surfacessptr srfss,int maxsurface,int maxspecies,int
 		srfss->epsilon=100*DBL_EPSILON;
 		srfss->margin=100*DBL_EPSILON;
 		srfss->neighdist=10*DBL_EPSILON;
+		srfss->localdiffuse=0;
 		srfss->snames=NULL;
 		srfss->srflist=NULL;
 		srfss->maxmollist=0;
@@ -1333,6 +1337,7 @@ void surfaceoutput(simptr sim) {
 	simLog(sim,1," Allocated for %i species\n",srfss->maxspecies-1);
 
 	simLog(sim,1," Surface epsilon, margin, and neighbor distances: %g|L %g|L %g|L\n",srfss->epsilon,srfss->margin,srfss->neighdist);
+	if(srfss->localdiffuse) simLog(sim,2," Surface-bound molecules on triangle panels diffuse in panel-local coordinates\n");
 
 	if(sim->mols) {
 		simLog(sim,1," Local max species record: %i\n",srfss->maxspecies);
@@ -1653,6 +1658,7 @@ void writesurfaces(simptr sim,FILE *fptr) {
 	fprintf(fptr,"epsilon %g\n",srfss->epsilon);
 	fprintf(fptr,"margin %g\n",srfss->margin);
 	fprintf(fptr,"neighbor_dist %g\n",srfss->neighdist);
+	if(srfss->localdiffuse) fprintf(fptr,"surface_diffusion local\n");
 	fprintf(fptr,"\n");
 	for(s=0;s<srfss->nsrf;s++) {
 		srf=srfss->srflist[s];
@@ -2093,6 +2099,18 @@ int surfsetneighdist(simptr sim,double neighdist) {
 	return 0; }
 
 
+/* surfsetlocaldiffuse */
+int surfsetlocaldiffuse(simptr sim,int local) {
+	int er;
+
+	if(!sim->srfss) {
+		er=surfenablesurfaces(sim,-1);
+		if(er) return 2; }
+	sim->srfss->localdiffuse=local;
+	surfsetcondition(sim->srfss,SCparams,0);
+	return 0; }
+
+
 /* surfsetneighhop */
 int surfsetneighhop(surfaceptr srf,int neighhop) {
 	if(!srf) return 1;
@@ -3021,6 +3039,7 @@ double srfcalcrate(simptr sim,surfaceptr srf,int i,enum MolecState ms1,enum Pane
 	else if(probrev>1) probrev=1;
 
 	dt=sim->dt;
+	if(face!=PFnone) dt*=molpairstepmult(sim,i,ms1,0,MSnone);		// collisions use the list's diffusion step
 	difc=sim->mols->difc[i][MSsoln];
 	difcrev=sim->mols->difc[i2][MSsoln];
 
@@ -3102,6 +3121,7 @@ double srfcalcprob(simptr sim,surfaceptr srf,int i,enum MolecState ms1,enum Pane
 	if(raterev<0 && raterev!=-1) raterev=0;
 
 	dt=sim->dt;
+	if(face!=PFnone) dt*=molpairstepmult(sim,i,ms1,0,MSnone);		// collisions use the list's diffusion step
 	difc=sim->mols->difc[i][MSsoln];
 	difcrev=sim->mols->difc[i2][MSsoln];
 
@@ -3173,6 +3193,7 @@ int surfsetneighbors(panelptr pnl,panelptr *neighlist,int nneigh,int add) {
 			if(p2<pnl->nneigh)
 				pnl->neigh[p2]=pnl->neigh[--pnl->nneigh]; }}
 
+	surfsetcondition(pnl->srf->srfss,SCparams,0);
 	return 0; }
 
 
@@ -3724,6 +3745,48 @@ int loadsurface(simptr sim,ParseFilePtr *pfpptr,char *line2) {
 	return 1; }
 
 
+/* surfsetedgeneighbors */
+void surfsetedgeneighbors(simptr sim) {
+	surfacessptr srfss;
+	surfaceptr srf;
+	panelptr pnl,pnl2;
+	int s,p,k,k2,q,d,nn,other,side;
+	double *v1,*v2,**point,mid[3],pt[3],maxdist;
+
+	srfss=sim->srfss;
+	maxdist=sqrt(srfss->neighdist);										// neighdist is compared to squared distances
+	for(s=0;s<srfss->nsrf;s++) {
+		srf=srfss->srflist[s];
+		for(p=0;p<srf->npanel[PStri];p++) {
+			pnl=srf->panels[PStri][p];
+			for(k=0;k<3;k++) {
+				v1=pnl->point[k];
+				v2=pnl->point[(k+1)%3];
+				for(d=0;d<3;d++) mid[d]=0.5*(v1[d]+v2[d]);
+				nn=other=0;
+				side=-1;
+				pnl2=NULL;
+				for(q=0;q<pnl->nneigh;q++) {								// look for neighbors that share this edge
+					if(pnl->neigh[q]->ps==PStri) {
+						point=pnl->neigh[q]->point;
+						for(k2=0;k2<3;k2++) {
+							if(distanceVVD(point[k2],v2,3)<maxdist && distanceVVD(point[(k2+1)%3],v1,3)<maxdist) break;
+							if(distanceVVD(point[k2],v1,3)<maxdist && distanceVVD(point[(k2+1)%3],v2,3)<maxdist) break; }
+						if(k2<3) {
+							nn++;
+							pnl2=pnl->neigh[q];
+							side=k2;
+							continue; }}
+					closestpanelpt(pnl->neigh[q],3,mid,pt,0);			// other neighbors that touch this edge
+					if(distanceVVD(pt,mid,3)<maxdist) other=1; }
+				if(other || nn>1) {
+					pnl2=NULL;
+					side=-2; }
+				pnl->edgeneigh[k]=pnl2;
+				pnl->edgeneighside[k]=side; }}}
+	return; }
+
+
 /* surfupdateparams */
 int surfupdateparams(simptr sim) {
 	surfacessptr srfss;
@@ -3790,6 +3853,9 @@ int surfupdateparams(simptr sim) {
 
 		surfsetemitterabsorption(sim); }
 
+	if(srfss->localdiffuse && sim->dim==3)
+		surfsetedgeneighbors(sim);
+
 	return 0; }
 
 
@@ -4817,6 +4883,70 @@ void movemol2closepanel(simptr sim,moleculeptr mptr) {
 	return; }
 
 
+/* movemolonpanels */
+void movemolonpanels(simptr sim,moleculeptr mptr,double dx,double dy) {
+	int d,k,side,iter;
+	double pt[3],pt2[3],disp[3],edgept[3],e2[3],*e1,*front,*outnorm,*innorm,a,across;
+	double posx[3];
+	panelptr pnl,pnlx;
+	enum PanelFace face;
+
+	pnl=mptr->pnl;
+	if(mptr->mstate==MSfront) face=PFfront;
+	else if(mptr->mstate==MSback) face=PFback;
+	else face=PFnone;
+
+	front=pnl->front;																	// panel-local axes are e1 and e2
+	e1=pnl->point[3];
+	e2[0]=front[1]*e1[2]-front[2]*e1[1];
+	e2[1]=front[2]*e1[0]-front[0]*e1[2];
+	e2[2]=front[0]*e1[1]-front[1]*e1[0];
+	for(d=0;d<3;d++) {
+		pt[d]=mptr->pos[d];
+		disp[d]=dx*e1[d]+dy*e2[d]; }
+
+	for(iter=0;iter<50;iter++) {
+		for(d=0;d<3;d++) pt2[d]=pt[d]+disp[d];
+		a=Geo_LineExitTriangle2(pt,pt2,pnl->point,edgept,&k);
+		if(!(a<1)) break;																// ends in this panel
+		if(a<0) {
+			a=0;
+			for(d=0;d<3;d++) edgept[d]=pt[d]; }
+		k--;
+		for(d=0;d<3;d++) {
+			disp[d]*=1.0-a;																// disp is the remaining displacement
+			pt[d]=edgept[d]; }
+		side=pnl->edgeneighside[k];
+		outnorm=pnl->point[3+k];
+		across=disp[0]*outnorm[0]+disp[1]*outnorm[1]+disp[2]*outnorm[2];
+
+		if(side==-1) {																	// no neighbor, so reflect off edge
+			for(d=0;d<3;d++) disp[d]-=2.0*across*outnorm[d]; }
+		else if(side>=0) {															// unfold onto neighbor across edge
+			innorm=pnl->edgeneigh[k]->point[3+side];
+			for(d=0;d<3;d++) disp[d]-=across*(outnorm[d]+innorm[d]);
+			pnl=pnl->edgeneigh[k]; }
+		else {																					// other connectivity, so use general method
+			for(d=0;d<3;d++) {
+				posx[d]=mptr->posx[d];
+				mptr->posx[d]=pt[d];
+				mptr->pos[d]=pt[d]+disp[d]; }
+			pnlx=mptr->pnlx;
+			mptr->pnlx=pnl;
+			mptr->pnl=pnl;
+			movemol2closepanel(sim,mptr);
+			for(d=0;d<3;d++) mptr->posx[d]=posx[d];
+			mptr->pnlx=pnlx;
+			return; }}
+
+	for(d=0;d<3;d++) mptr->pos[d]=pt2[d];
+	if(iter==50) movept2panel(mptr->pos,pnl,3,sim->srfss->margin);
+	fixpt2panel(mptr->pos,pnl,3,face,sim->srfss->epsilon);
+	mptr->pnl=pnl;
+	sim->mols->touch++;
+	return; }
+
+
 /* surfacereflect */
 void surfacereflect(moleculeptr mptr,panelptr pnl,double *crsspt,int dim,enum PanelFace face) {
 	int d,axis;
@@ -5036,6 +5166,7 @@ int dosurfinteract(simptr sim,moleculeptr mptr,int ll,int m,panelptr pnl,enum Pa
 			mptr2->posoffset[d]=mptr->posoffset[d]; }
 		mptr2->box=pos2box(sim,mptr2->pos);
 		mptr2->list=sim->mols->listlookup[i2][MSsoln];
+		molcountadd(sim->mols,mptr2);
 		sim->eventcount[ETdesorb]++;
 		molkill(sim,mptr,ll,m);
 		checksurfaces1mol(sim,mptr2,0);
@@ -5112,7 +5243,7 @@ int checksurfaces1mol(simptr sim,moleculeptr mptr,double crossminimum) {
 
 /* checksurfaces. */
 int checksurfaces(simptr sim,int ll,int reborn) {
-	int dim,d,nmol,m,done,p,lxp,it,flag;
+	int dim,d,nmol,m,done,p,lxp,it,flag,mixed;
 	boxptr bptr1;
 	moleculeptr *mlist,mptr;
 	double crossmin,crossmin2,crssptmin[3],crsspt[3],cross,*via,*pos;
@@ -5128,9 +5259,11 @@ int checksurfaces(simptr sim,int ll,int reborn) {
 
 	if(!reborn) m=0;
 	else m=sim->mols->topl[ll];
+	mixed=(!reborn && sim->mols->diffuselist[ll]==2);
 
 	for(;m<nmol;m++) {
 		mptr=mlist[m];
+		if(mixed && !sim->mols->mobile[mptr->ident][mptr->mstate]) continue;	// immobile molecules can't cross panels
 		via=mptr->via;
 		for(d=0;d<dim;d++) via[d]=mptr->posx[d];
 		pos=mptr->pos;
@@ -32,6 +32,7 @@ wallptr *wallsalloc(int dim);
 // structure setup
 
 // core simulation functions
+static inline int checkwallsdim(simptr sim,int ll,int reborn,boxptr bptr,const int dim);
 
 
 /******************************************************************************/
@@ -364,9 +365,9 @@ int checkwalls1mol(simptr sim,moleculeptr mptr) {
 	return 0; }
 
 
-/* checkwalls */
-int checkwalls(simptr sim,int ll,int reborn,boxptr bptr) {
-	int nmol,w,d,m;
+/* checkwallsdim */
+static inline int checkwallsdim(simptr sim,int ll,int reborn,boxptr bptr,const int dim) {
+	int nmol,w,d,m,mixed,**mobile;
 	moleculeptr *mlist;
 	double pos2,diff,difi,step,**difstep;
 	wallptr wptr;
@@ -381,39 +382,42 @@ int checkwalls(simptr sim,int ll,int reborn,boxptr bptr) {
 	if(!reborn) m=0;
 	else if(reborn&&!bptr) m=sim->mols->topl[ll];
 	else {m=0;simLog(sim,10,"SMOLDYN ERROR: in checkwalls, both bptr and reborn are defined");}
+	mobile=sim->mols->mobile;
+	mixed=(!reborn && !bptr && sim->mols->diffuselist[ll]==2);		// immobile molecules can't cross walls
 
-	for(w=0;w<2*sim->dim;w++) {
+	for(w=0;w<2*dim;w++) {
 		wptr=sim->wlist[w];
 		d=wptr->wdim;
 		if(wptr->type=='r'&&wptr->side==0) {			// reflective
 			pos2=2*wptr->pos;
 			for(m=0;m<nmol;m++)
-				if(mlist[m]->pos[d]<wptr->pos) {
+				if(mlist[m]->pos[d]<wptr->pos && (!mixed || mobile[mlist[m]->ident][mlist[m]->mstate])) {
 					sim->eventcount[ETwall]++;
 					mlist[m]->pos[d]=pos2-mlist[m]->pos[d];}}
 		else if(wptr->type=='r') {
 			pos2=2*wptr->pos;
 			for(m=0;m<nmol;m++)
-				if(mlist[m]->pos[d]>wptr->pos) {
+				if(mlist[m]->pos[d]>wptr->pos && (!mixed || mobile[mlist[m]->ident][mlist[m]->mstate])) {
 					sim->eventcount[ETwall]++;
 					mlist[m]->pos[d]=pos2-mlist[m]->pos[d];}}
 		else if(wptr->type=='p'&&wptr->side==0) {	// periodic
 			pos2=wptr->opp->pos-wptr->pos;
 			for(m=0;m<nmol;m++)
-				if(mlist[m]->pos[d]<wptr->pos) {
+				if(mlist[m]->pos[d]<wptr->pos && (!mixed || mobile[mlist[m]->ident][mlist[m]->mstate])) {
 					sim->eventcount[ETwall]++;
 					mlist[m]->pos[d]+=pos2;
 					mlist[m]->posoffset[d]-=pos2; }}
 		else if(wptr->type=='p') {
 			pos2=wptr->opp->pos-wptr->pos;
 			for(m=0;m<nmol;m++)
-				if(mlist[m]->pos[d]>wptr->pos) {
+				if(mlist[m]->pos[d]>wptr->pos && (!mixed || mobile[mlist[m]->ident][mlist[m]->mstate])) {
 					sim->eventcount[ETwall]++;
 					mlist[m]->pos[d]+=pos2;
 					mlist[m]->posoffset[d]-=pos2; }}
 		else if(wptr->type=='a') {								// absorbing
 			difstep=sim->mols->difstep;
 			for(m=0;m<nmol;m++) {
+				if(mixed && !mobile[mlist[m]->ident][mlist[m]->mstate]) continue;
 				diff=wptr->pos-mlist[m]->pos[d];
 				difi=wptr->pos-mlist[m]->posx[d];
 				step=difstep[mlist[m]->ident][MSsoln];
@@ -424,4 +428,24 @@ int checkwalls(simptr sim,int ll,int reborn,boxptr bptr) {
 	return 0; }
 
 
+/* checkwalls */
+int checkwalls(simptr sim,int ll,int reborn,boxptr bptr) {
+	return checkwallsdim(sim,ll,reborn,bptr,sim->dim); }
+
+
+/* checkwalls1D */
+int checkwalls1D(simptr sim,int ll,int reborn,boxptr bptr) {
+	return checkwallsdim(sim,ll,reborn,bptr,1); }
+
+
+/* checkwalls2D */
+int checkwalls2D(simptr sim,int ll,int reborn,boxptr bptr) {
+	return checkwallsdim(sim,ll,reborn,bptr,2); }
+
+
+/* checkwalls3D */
+int checkwalls3D(simptr sim,int ll,int reborn,boxptr bptr) {
+	return checkwallsdim(sim,ll,reborn,bptr,3); }
+
+
 
@@ -418,6 +418,33 @@ uint32_t gen_rand32(void) {
     r = psfmt32[idx++];
     return r;
 }
+
+/**
+ * This function fills the array with 32-bit pseudorandom numbers. Unlike
+ * fill_array32, it continues the same sequence that gen_rand32 produces,
+ * so the two functions can be mixed freely, and any size is allowed.
+ * init_gen_rand or init_by_array must be called before this function.
+ * @param array an array where pseudorandom 32-bit integers are filled
+ * by this function.
+ * @param size number of 32-bit pseudorandom integers to be generated.
+ */
+void gen_rand32_array(uint32_t *array, int size) {
+    int n;
+
+    assert(initialized);
+    while (size > 0) {
+	if (idx >= N32) {
+	    gen_rand_all();
+	    idx = 0;
+	}
+	n = N32 - idx;
+	if (n > size) n = size;
+	memcpy(array, psfmt32 + idx, n * sizeof(uint32_t));
+	idx += n;
+	array += n;
+	size -= n;
+    }
+}
 #endif
 /**
  * This function generates and returns 64-bit pseudorandom number.
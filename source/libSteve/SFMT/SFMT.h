@@ -75,6 +75,7 @@
 #endif
 
 uint32_t gen_rand32(void);
+void gen_rand32_array(uint32_t *array, int size);
 uint64_t gen_rand64(void);
 void fill_array32(uint32_t *array, int size);
 void fill_array64(uint64_t *array, int size);
@@ -8,6 +8,20 @@ of the Gnu Lesser General Public License (LGPL). */
 #include "random2.h"
 #include "math2.h"
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define RANDSIMDX86
+	#include <immintrin.h>
+#endif
+
+#define ZIGBLOCK 256
+
+static uint32_t ZigKn[256];				// Ziggurat tables for Gaussian random numbers
+static double ZigWn[256],ZigFn[256];
+static int ZigInit=0;
+static int ZigSimd=-1;
+
+static double gausszigfix(uint32_t u,uint64_t *stream);
+
 
 double unirandsumCCD(int n,double m,double s) {
 	double x=0;
@@ -418,6 +432,218 @@ void randshuffletableV(void **a,int n) {
 	return; }
 
 
+void randstreaminit(uint64_t *state,uint64_t seed,int jumps) {
+	int i;
+	uint64_t z;
+
+	for(i=0;i<4;i++) {								// splitmix64 seeding
+		seed+=0x9e3779b97f4a7c15ULL;
+		z=seed;
+		z=(z^(z>>30))*0xbf58476d1ce4e5b9ULL;
+		z=(z^(z>>27))*0x94d049bb133111ebULL;
+		state[i]=z^(z>>31); }
+	for(i=0;i<jumps;i++)
+		randstreamjump(state);
+	return; }
+
+
+void randstreamjump(uint64_t *state) {
+	static const uint64_t jump[4]={0x180ec6d33cfd0abaULL,0xd5a61266f0c9392cULL,0xa9582618e03fc9aaULL,0x39abdc4529b1661cULL};
+	uint64_t s[4];
+	int i,b,d;
+
+	for(d=0;d<4;d++) s[d]=0;
+	for(i=0;i<4;i++)
+		for(b=0;b<64;b++) {
+			if(jump[i]&((uint64_t)1<<b))
+				for(d=0;d<4;d++) s[d]^=state[d];
+			randstreamnext(state); }
+	for(d=0;d<4;d++) state[d]=s[d];
+	return; }
+
+
+void randstreamULIarray(uint64_t *state,uint32_t *array,int n) {
+	int i;
+
+	for(i=0;i<n;i++)
+		array[i]=randstreamULI(state);
+	return; }
+
+
+/* Ziggurat method for Gaussian random numbers, from Marsaglia and Tsang, J.
+Stat. Software 5:8, 2000, but with 256 layers. The 8 low bits of each random
+integer choose the layer and the other 24 bits give the value, so the two are
+independent. About 1.5% of values need the slow path in gausszigfix. */
+
+void gaussziginit(void) {
+	double m1,dn,tn,vn,q;
+	int i;
+
+	if(ZigInit) return;
+	m1=2147483648.0;
+	dn=3.6541528853610088;
+	tn=dn;
+	vn=4.92867323399e-3;
+	q=vn/exp(-0.5*dn*dn);
+	ZigKn[0]=(uint32_t)((dn/q)*m1);
+	ZigKn[1]=0;
+	ZigWn[0]=q/m1;
+	ZigWn[255]=dn/m1;
+	ZigFn[0]=1.0;
+	ZigFn[255]=exp(-0.5*dn*dn);
+	for(i=254;i>=1;i--) {
+		dn=sqrt(-2.0*log(vn/dn+exp(-0.5*dn*dn)));
+		ZigKn[i+1]=(uint32_t)((dn/tn)*m1);
+		tn=dn;
+		ZigFn[i]=exp(-0.5*dn*dn);
+		ZigWn[i]=dn/m1; }
+#ifdef RANDSIMDX86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx512f")) ZigSimd=2;
+	else if(__builtin_cpu_supports("avx2")) ZigSimd=1;
+	else ZigSimd=0;
+#else
+	ZigSimd=0;
+#endif
+	ZigInit=1;
+	return; }
+
+
+static inline uint32_t gausszigrand(uint64_t *stream) {
+	return stream?randstreamULI(stream):(uint32_t)randULI(); }
+
+
+static inline double gausszigunif(uint64_t *stream) {
+	return ((double)gausszigrand(stream)+0.5)*(1.0/4294967296.0); }
+
+
+static double gausszigfix(uint32_t u,uint64_t *stream) {
+	int32_t hz;
+	uint32_t iz,ahz;
+	double x,y;
+
+	for(;;) {
+		iz=u&255;
+		hz=(int32_t)(u&~(uint32_t)255);
+		x=hz*ZigWn[iz];
+		if(iz==0) {															// base strip, sample the tail
+			do {
+				x=-log(gausszigunif(stream))*0.2736612373297583;
+				y=-log(gausszigunif(stream)); }
+				while(y+y<x*x);
+			return hz>0?3.6541528853610088+x:-3.6541528853610088-x; }
+		if(ZigFn[iz]+gausszigunif(stream)*(ZigFn[iz-1]-ZigFn[iz])<exp(-0.5*x*x)) return x;
+		u=gausszigrand(stream);
+		iz=u&255;
+		hz=(int32_t)(u&~(uint32_t)255);
+		ahz=hz<0?(uint32_t)0-(uint32_t)hz:(uint32_t)hz;
+		if(ahz<ZigKn[iz]) return hz*ZigWn[iz]; }}
+
+
+double gausszigD(uint64_t *stream) {
+	uint32_t u,iz,ahz;
+	int32_t hz;
+
+	if(!ZigInit) gaussziginit();
+	u=gausszigrand(stream);
+	iz=u&255;
+	hz=(int32_t)(u&~(uint32_t)255);
+	ahz=hz<0?(uint32_t)0-(uint32_t)hz:(uint32_t)hz;
+	if(ahz<ZigKn[iz]) return hz*ZigWn[iz];
+	return gausszigfix(u,stream); }
+
+
+static inline int gausszigblock(double *array,const uint32_t *rnd,int *rejlist,int n) {
+	uint32_t u,iz,ahz;
+	int32_t hz;
+	int i,nrej;
+
+	nrej=0;
+	for(i=0;i<n;i++) {
+		u=rnd[i];
+		iz=u&255;
+		hz=(int32_t)(u&~(uint32_t)255);
+		ahz=hz<0?(uint32_t)0-(uint32_t)hz:(uint32_t)hz;
+		array[i]=hz*ZigWn[iz];
+		if(ahz>=ZigKn[iz]) rejlist[nrej++]=i; }
+	return nrej; }
+
+
+#ifdef RANDSIMDX86
+__attribute__((target("avx2")))
+static int gausszigblockavx2(double *array,const uint32_t *rnd,int *rejlist,int n) {
+	int i,j,nrej,mask;
+	__m128i u,iz,hz,ahz,kn,rej,m255;
+	__m256d wn;
+
+	m255=_mm_set1_epi32(255);
+	nrej=0;
+	for(i=0;i+4<=n;i+=4) {
+		u=_mm_loadu_si128((const __m128i*)(rnd+i));
+		iz=_mm_and_si128(u,m255);
+		hz=_mm_andnot_si128(m255,u);
+		ahz=_mm_abs_epi32(hz);
+		kn=_mm_i32gather_epi32((const int*)ZigKn,iz,4);
+		wn=_mm256_i32gather_pd(ZigWn,iz,8);
+		_mm256_storeu_pd(array+i,_mm256_mul_pd(_mm256_cvtepi32_pd(hz),wn));
+		rej=_mm_cmpeq_epi32(_mm_max_epu32(ahz,kn),ahz);		// unsigned ahz>=kn
+		for(mask=_mm_movemask_ps(_mm_castsi128_ps(rej));mask;mask&=mask-1)
+			rejlist[nrej++]=i+__builtin_ctz(mask); }
+	if(i<n) {
+		j=nrej;
+		nrej+=gausszigblock(array+i,rnd+i,rejlist+nrej,n-i);
+		for(;j<nrej;j++) rejlist[j]+=i; }
+	return nrej; }
+
+
+__attribute__((target("avx512f")))
+static int gausszigblockavx512(double *array,const uint32_t *rnd,int *rejlist,int n) {
+	int i,j,nrej,mask;
+	__m256i u,iz,hz,ahz,kn,rej,m255;
+	__m512d wn;
+
+	m255=_mm256_set1_epi32(255);
+	nrej=0;
+	for(i=0;i+8<=n;i+=8) {
+		u=_mm256_loadu_si256((const __m256i*)(rnd+i));
+		iz=_mm256_and_si256(u,m255);
+		hz=_mm256_andnot_si256(m255,u);
+		ahz=_mm256_abs_epi32(hz);
+		kn=_mm256_i32gather_epi32((const int*)ZigKn,iz,4);
+		wn=_mm512_i32gather_pd(iz,ZigWn,8);
+		_mm512_storeu_pd(array+i,_mm512_mul_pd(_mm512_cvtepi32_pd(hz),wn));
+		rej=_mm256_cmpeq_epi32(_mm256_max_epu32(ahz,kn),ahz);	// unsigned ahz>=kn
+		for(mask=_mm256_movemask_ps(_mm256_castsi256_ps(rej));mask;mask&=mask-1)
+			rejlist[nrej++]=i+__builtin_ctz(mask); }
+	if(i<n) {
+		j=nrej;
+		nrej+=gausszigblock(array+i,rnd+i,rejlist+nrej,n-i);
+		for(;j<nrej;j++) rejlist[j]+=i; }
+	return nrej; }
+#endif
+
+
+void gausszigarrayD(double *array,int n,uint64_t *stream) {
+	uint32_t rnd[ZIGBLOCK];
+	int rejlist[ZIGBLOCK];
+	int i,nb,nrej;
+
+	if(!ZigInit) gaussziginit();
+	for(;n>0;n-=nb,array+=nb) {
+		nb=n<ZIGBLOCK?n:ZIGBLOCK;
+		if(stream) randstreamULIarray(stream,rnd,nb);
+		else randULIarray(rnd,nb);
+#ifdef RANDSIMDX86
+		if(ZigSimd==2) nrej=gausszigblockavx512(array,rnd,rejlist,nb);
+		else if(ZigSimd==1) nrej=gausszigblockavx2(array,rnd,rejlist,nb);
+		else
+#endif
+		nrej=gausszigblock(array,rnd,rejlist,nb);
+		for(i=0;i<nrej;i++)														// redo the rare rejections in order
+			array[rejlist[i]]=gausszigfix(rnd[rejlist[i]],stream); }
+	return; }
+
+
 void showdist(int n,float low,float high,int bin) {
 	int i,a[100],uflow=0,oflow=0,b;
 	float x,sum=0,sum2=0;
@@ -16,6 +16,7 @@ extern "C" {
 #include <time.h>
 #include <stdlib.h>
 #include <math.h>
+#include <stdint.h>
 
 /* Definitions of basic random number generators */
 #ifdef SFMT_H
@@ -52,6 +53,9 @@ extern "C" {
 	inline static unsigned long int randULI(void) {
 		return (unsigned long int) gen_rand32(); }
 
+	inline static void randULIarray(uint32_t *array,int n) {
+		gen_rand32_array(array,n); }
+
 	inline static long int randomize(long int seed) {
 		if(seed<0) seed=(long int) time(NULL);
 		init_gen_rand((uint32_t)seed);
@@ -97,6 +101,10 @@ extern "C" {
 	inline static unsigned long int randULI(void) {
 		return rand30(); }
 
+	inline static void randULIarray(uint32_t *array,int n) {
+		int i;
+		for(i=0;i<n;i++) array[i]=(uint32_t)rand30(); }
+
 	inline static long int randomize(long int seed) {
 		if(seed<0) seed=(unsigned int) time(NULL);
 		srand((unsigned int)seed);
@@ -172,6 +180,25 @@ inline static float thetarandCCF(void) {
 	return (float) acos(1.0-2.0*randCCF()); }
 
 
+/* Independent random number streams, using xoshiro256**, for use in threads */
+
+inline static uint64_t randstreamnext(uint64_t *state) {
+	uint64_t result,t;
+	result=state[1]*5;
+	result=((result<<7)|(result>>57))*9;
+	t=state[1]<<17;
+	state[2]^=state[0];
+	state[3]^=state[1];
+	state[1]^=state[2];
+	state[0]^=state[3];
+	state[2]^=t;
+	state[3]=(state[3]<<45)|(state[3]>>19);
+	return result; }
+
+inline static uint32_t randstreamULI(uint64_t *state) {
+	return (uint32_t)(randstreamnext(state)>>32); }
+
+
 double unirandsumCCD(int n,double m,double s);
 float unirandsumCCF(int n,float m,float s);
 int intrandpD(int n,double *p);
@@ -193,6 +220,12 @@ void randshuffletableD(double *a,int n);
 void randshuffletableF(float *a,int n);
 void randshuffletableI(int *a,int n);
 void randshuffletableV(void **a,int n);
+void randstreaminit(uint64_t *state,uint64_t seed,int jumps);
+void randstreamjump(uint64_t *state);
+void randstreamULIarray(uint64_t *state,uint32_t *array,int n);
+void gaussziginit(void);
+double gausszigD(uint64_t *stream);
+void gausszigarrayD(double *array,int n,uint64_t *stream);
 void showdist(int n,float low,float high,int bin);
 
 #ifdef __cplusplus
@@ -509,6 +509,12 @@ PYBIND11_MODULE(_smoldyn, m)
             return smolSetRandomSeed(sim.getSimPtr(), seed);
         })
 
+      // enum ErrorCode smolSetThreads(simptr sim, int nthreads);
+      .def("setThreads",
+        [](Simulation& sim, int nthreads) {
+            return smolSetThreads(sim.getSimPtr(), nthreads);
+        })
+
       // enum ErrorCode smolSetPartitions(simptr sim, const char *method,
       // double value);
       .def("setPartitions",
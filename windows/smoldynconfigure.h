@@ -43,6 +43,9 @@
 /* Whether to compile Smoldyn with Zlib support */
 /* #undef HAVE_ZLIB */
 
+/* Whether to compile Smoldyn with OpenMP support */
+/* #undef HAVE_OPENMP */
+
 /* Whether to compile Smoldyn with lattice support */
 /* #undef OPTION_LATTICE */
 